@@ -31,27 +31,291 @@
 #ifndef FUN_HARDWARE_H_
 #define FUN_HARDWARE_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
+/*
+ * Clock sources:
+ *
+ *  Linux              CLOCK_MONOTONIC (clock_gettime uses the vDSO: no system call).
+ *  Linux + HW_CLOCK_TSC  x86-64 invariant TSC scaled to ns. Calibrated against CLOCK_MONOTONIC by
+ *                     hw_clock_init() at startup (busy waits HW_TSC_CALIBRATION_MS); CLOCK_MONOTONIC
+ *                     is used until then. hw_tsc_drift(), called periodically (ex: once per second),
+ *                     measures the rate again over the whole elapsed time and, when the error is above
+ *                     HW_TSC_MAX_DRIFT_NS, slews it out over the next period: time never steps.
+ *                     Without invariant TSC it falls back to CLOCK_MONOTONIC.
+ *  others             stub, returns 0: to be implemented by port.
+ *
+ *  hw_clock_set() replaces the source of hw_nanos(), hw_millis() and hw_micros(). hw_clock_virtual()
+ *  installs a clock that only moves on hw_clock_advance(): programs with long presets can be simulated
+ *  faster than real time with exact, reproducible timestamps.
+ */
+
+#ifndef HW_TSC_CALIBRATION_MS
+#define HW_TSC_CALIBRATION_MS  10      /**< calibration time */
+#endif
+#ifndef HW_TSC_MAX_DRIFT_NS
+#define HW_TSC_MAX_DRIFT_NS    100000  /**< max error before slewing */
+#endif
+
+#ifdef __linux__
+#include <time.h>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HW_HAVE_TSC
+#endif
+
+/**
+ * @fn static inline uint64_t hw_monotonic_nanos(void)
+ * @brief CLOCK_MONOTONIC time
+ *
+ * @return ns
+ */
+static inline uint64_t hw_monotonic_nanos(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+#ifdef HW_HAVE_TSC
+/**
+ * @typedef hw_tsc_t
+ * @brief TSC to ns conversion: ns = ns0 + ((tsc - tsc0) * mult) >> 32
+ *
+ */
+typedef struct hw_tsc_t {
+    uint64_t tsc0;     /**< base tsc */
+    uint64_t ns0;      /**< time of base tsc */
+    uint64_t mult;     /**< ns per tick (32.32 fixed point) */
+    uint64_t cal_tsc;  /**< tsc at calibration start */
+    uint64_t cal_ns;   /**< time at calibration start */
+    uint64_t check_ns; /**< time of calibration or last drift check */
+        bool valid;    /**< calibrated */
+        bool usable;   /**< invariant TSC present */
+} hw_tsc_t;
+
+static hw_tsc_t hw_tsc = { 0 };
+
+/**
+ * @fn bool hw_tsc_calibrate(uint32_t ms)
+ * @brief measure TSC frequency against CLOCK_MONOTONIC for ms milliseconds
+ *
+ * @param ms
+ * @return false if no invariant TSC
+ */
+bool hw_tsc_calibrate(uint32_t ms) {
+    unsigned int eax, ebx, ecx, edx;
+
+    hw_tsc.valid = true;
+    hw_tsc.usable = __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1 << 8));
+    if (!hw_tsc.usable)
+        return false;
+
+    hw_tsc.cal_ns = hw_monotonic_nanos();
+    hw_tsc.cal_tsc = __rdtsc();
+    uint64_t ns;
+    do {
+        ns = hw_monotonic_nanos();
+    } while (ns - hw_tsc.cal_ns < (uint64_t) ms * 1000000);
+    uint64_t tsc = __rdtsc();
+
+    hw_tsc.mult = (uint64_t) (((unsigned __int128) (ns - hw_tsc.cal_ns) << 32) / (tsc - hw_tsc.cal_tsc));
+    hw_tsc.tsc0 = tsc;
+    hw_tsc.ns0 = ns;
+    hw_tsc.check_ns = ns;
+
+    return true;
+}
+
+/**
+ * @fn static inline uint64_t hw_tsc_time(uint64_t tsc)
+ * @brief TSC time of tsc
+ *
+ * @param tsc
+ * @return ns
+ */
+static inline uint64_t hw_tsc_time(uint64_t tsc) {
+    return hw_tsc.ns0 + (uint64_t) (((unsigned __int128) (tsc - hw_tsc.tsc0) * hw_tsc.mult) >> 32);
+}
+
+/**
+ * @fn static inline uint64_t hw_tsc_nanos(void)
+ * @brief TSC time (same origin as CLOCK_MONOTONIC). CLOCK_MONOTONIC until calibrated
+ *
+ * @return ns
+ */
+static inline uint64_t hw_tsc_nanos(void) {
+    if (!hw_tsc.valid || !hw_tsc.usable)
+        return hw_monotonic_nanos();
+
+    return hw_tsc_time(__rdtsc());
+}
+
+/**
+ * @fn int64_t hw_tsc_drift(void)
+ * @brief error of TSC time against CLOCK_MONOTONIC. The rate is measured again over all time from calibration;
+ *        an error above HW_TSC_MAX_DRIFT_NS is slewed out over a period as long as the one since previous check
+ *        (at most half of it is corrected). TSC time stays continuous and monotonic
+ *
+ * @return ns (positive: TSC ahead)
+ */
+int64_t hw_tsc_drift(void) {
+    if (!hw_tsc.valid || !hw_tsc.usable)
+        return 0;
+
+    uint64_t tsc = __rdtsc();
+    uint64_t ns = hw_monotonic_nanos();
+    uint64_t tsc_ns = hw_tsc_time(tsc);
+    int64_t drift = (int64_t) (tsc_ns - ns);
+    int64_t period = (int64_t) (ns - hw_tsc.check_ns);
+
+    if (period <= 0 || tsc == hw_tsc.cal_tsc)
+        return drift;
+
+    uint64_t rate = (uint64_t) (((unsigned __int128) (ns - hw_tsc.cal_ns) << 32) / (tsc - hw_tsc.cal_tsc));
+    int64_t slew = 0;
+    if (drift > HW_TSC_MAX_DRIFT_NS || drift < -HW_TSC_MAX_DRIFT_NS) {
+        slew = drift;
+        if (slew > period / 2)
+            slew = period / 2;
+        if (slew < -period / 2)
+            slew = -period / 2;
+    }
+
+    hw_tsc.mult = (uint64_t) (((unsigned __int128) rate * (uint64_t) (period - slew)) / (uint64_t) period);
+    hw_tsc.tsc0 = tsc;
+    hw_tsc.ns0 = tsc_ns;
+    hw_tsc.check_ns = ns;
+
+    return drift;
+}
+#endif
+
+/**
+ * @typedef hw_clock_t
+ * @brief time source
+ *
+ * @param arg
+ * @return ns
+ */
+typedef uint64_t (*hw_clock_t)(void *arg);
+
+static hw_clock_t hw_clock_source = NULL; /**< NULL: default source */
+static void *hw_clock_arg = NULL;         /**< argument of source */
+
+/**
+ * @fn static inline void hw_clock_set(hw_clock_t source, void *arg)
+ * @brief select time source (NULL for default)
+ *
+ * @param source
+ * @param arg
+ */
+static inline void hw_clock_set(hw_clock_t source, void *arg) {
+    hw_clock_source = source;
+    hw_clock_arg = arg;
+}
+
+/**
+ * @typedef hw_virtual_clock_t
+ * @brief simulated time
+ *
+ */
+typedef struct hw_virtual_clock_t {
+    uint64_t ns; /**< current time */
+} hw_virtual_clock_t;
+
+/**
+ * @fn static uint64_t hw_virtual_nanos(void *arg)
+ * @brief source of virtual clock
+ *
+ * @param arg
+ * @return ns
+ */
+static uint64_t hw_virtual_nanos(void *arg) {
+    return ((hw_virtual_clock_t*) arg)->ns;
+}
+
+/**
+ * @fn static inline void hw_clock_virtual(hw_virtual_clock_t *clock, uint64_t ns)
+ * @brief use clock as time source, starting from ns
+ *
+ * @param clock
+ * @param ns
+ */
+static inline void hw_clock_virtual(hw_virtual_clock_t *clock, uint64_t ns) {
+    clock->ns = ns;
+    hw_clock_set(hw_virtual_nanos, clock);
+}
+
+/**
+ * @fn static inline void hw_clock_advance(hw_virtual_clock_t *clock, uint64_t ns)
+ * @brief
+ *
+ * @param clock
+ * @param ns
+ */
+static inline void hw_clock_advance(hw_virtual_clock_t *clock, uint64_t ns) {
+    clock->ns += ns;
+}
+
+/**
+ * @fn static inline bool hw_clock_init(void)
+ * @brief prepare default time source. To be called at startup: with HW_CLOCK_TSC it calibrates the TSC
+ *        (busy waits HW_TSC_CALIBRATION_MS), so no later read of time waits
+ *
+ * @return false if the default source is not available
+ */
+static inline bool hw_clock_init(void) {
+#if defined(HW_CLOCK_TSC) && defined(HW_HAVE_TSC)
+    hw_tsc_calibrate(HW_TSC_CALIBRATION_MS);
+    return true;
+#elif defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @fn static inline uint64_t hw_nanos(void)
+ * @brief time of selected clock source
+ *
+ * @return ns
+ */
+static inline uint64_t hw_nanos(void) {
+    if (hw_clock_source != NULL)
+        return hw_clock_source(hw_clock_arg);
+#if defined(HW_CLOCK_TSC) && defined(HW_HAVE_TSC)
+    return hw_tsc_nanos();
+#elif defined(__linux__)
+    return hw_monotonic_nanos();
+#else
+    return 0;
+#endif
+}
+
 #ifdef ALLOW_64BITS
 /**
- * @fn uint32_t hw_millis(void)
+ * @fn uint64_t hw_millis(void)
  * @brief
  *
  * @return
  */
 uint64_t hw_millis(void) {
-    return 0;
+    return hw_nanos() / 1000000;
 }
 
 /**
- * @fn uint32_t hw_millis(void)
+ * @fn uint64_t hw_micros(void)
  * @brief
  *
  * @return
  */
 uint64_t hw_micros(void) {
-    return 0;
+    return hw_nanos() / 1000;
 }
 #else
 /**
@@ -61,7 +325,7 @@ uint64_t hw_micros(void) {
  * @return
  */
 uint32_t hw_millis(void) {
-    return 0;
+    return (uint32_t) (hw_nanos() / 1000000);
 }
 
 /**
@@ -71,7 +335,7 @@ uint32_t hw_millis(void) {
  * @return
  */
 uint32_t hw_micros(void) {
-    return 0;
+    return (uint32_t) (hw_nanos() / 1000);
 }
 #endif
 
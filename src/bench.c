@@ -0,0 +1,350 @@
+/**
+ * @file bench.c
+ * @brief benchmarks
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "iec61131lib.h"
+#include "iec_arithmetic.h"
+#include "iec_batch.h"
+#include "iec_comparison.h"
+#include "iec_bool_bank.h"
+#include "iec_edge.h"
+#include "iec_std_fun_blocks.h"
+#include "iec_string.h"
+#include "iec_timer_wheel.h"
+#include "iec_timer_bank.h"
+#include "util_search.h"
+
+#define LOOPS 10000000
+
+/**
+ * @def BENCH
+ * @brief run code loops times (i is loop counter) and print time per iteration
+ *
+ */
+#define BENCH(name, loops, code)                                                                  \
+            do {                                                                                  \
+                uint64_t start = bench_now();                                                     \
+                for (uint32_t i = 0; i < (loops); i++) {                                          \
+                    code;                                                                         \
+                }                                                                                 \
+                printf("  %-32s %8.2f ns\n", name, (double) (bench_now() - start) / (loops));     \
+            } while (0)
+
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* previous implementation: operands and result go through double */
+static uint8_t sub_double(iec_t *result, iec_t v1, iec_t v2) {
+    iec_anytype_allowed(v1, ANY_MAGNITUDE,,,,,);
+    iec_anytype_allowed(v2, ANY_MAGNITUDE,,,,,);
+    iec_arith_result(result, v1, v2);
+    iec_set_real(*result, iec_get_real(v1) - iec_get_real(v2));
+    return IEC_OK;
+}
+
+static uint8_t div_double(iec_t *result, iec_t v1, iec_t v2) {
+    iec_anytype_allowed(v1, ANY_MAGNITUDE,ANY_NUM,,,,);
+    iec_anytype_allowed(v2, ANY_MAGNITUDE,ANY_NUM,,,,);
+    if ((iec_get_real(v2)) == 0)
+        return IEC_NAT;
+    iec_arith_result(result, v1, v2);
+    iec_set_real(*result, iec_get_real(v1) / iec_get_real(v2));
+    return IEC_OK;
+}
+
+static void bench_arithmetic(iectype_t type, const char *name) {
+    iec_t result = IEC_ALLOC;
+    iec_t v1 = IEC_ALLOC;
+    iec_t v2 = IEC_ALLOC;
+    iec_init(&result, IEC_T_NULL);
+    iec_init(&v1, type);
+    iec_init(&v2, type);
+    iec_set_value(v2, 3);
+    iec_t args[8] = { v1, v2, v1, v2, v1, v2, v1, v2 };
+
+    printf("_  BENCH ARITHMETIC %s\n", name);
+    BENCH("SUB double", LOOPS, iec_set_int(v1, i); sub_double(&result, v1, v2));
+    BENCH("SUB native", LOOPS, iec_set_int(v1, i); iec_sub(&result, v1, v2));
+    BENCH("DIV double", LOOPS, iec_set_int(v1, i); div_double(&result, v1, v2));
+    BENCH("DIV native", LOOPS, iec_set_int(v1, i); iec_div(&result, v1, v2));
+    BENCH("ADD 8 inputs", LOOPS, iec_set_int(v1, i); iec_add_n(&result, args, 8));
+    printf("\n");
+
+    iec_deinit(&result);
+    iec_deinit(&v1);
+    iec_deinit(&v2);
+}
+
+static void bench_batch(void) {
+    static int32_t ia[4096], ib[4096], id[4096];
+    static float fa[4096], fb[4096], fd[4096];
+    static uint64_t mask[IEC_BATCH_MASK_WORDS(4096)];
+    const char *level_name[] = { "scalar", "SSE2", "AVX2" };
+    char name[64];
+
+    for (int n = 0; n < 4096; n++) {
+        ia[n] = n;
+        ib[n] = 4096 - n;
+        fa[n] = n * 0.25f;
+        fb[n] = 1.5f;
+    }
+
+    printf("_  BENCH BATCH (4096 elements, per batch)\n");
+    for (int level = IEC_BATCH_NONE; level <= IEC_BATCH_AVX2; level++) {
+        iec_batch_max_level = level;
+        if (iec_batch_level() != level)
+            continue;
+        snprintf(name, sizeof(name), "ADD DINT %s", level_name[level]);
+        BENCH(name, 10000, ia[0] = i; iec_add_batch(id, ia, ib, 4096, IEC_T_DINT));
+        snprintf(name, sizeof(name), "MUL REAL %s", level_name[level]);
+        BENCH(name, 10000, fa[0] = i; iec_mul_batch(fd, fa, fb, 4096, IEC_T_REAL));
+        snprintf(name, sizeof(name), "GT REAL %s", level_name[level]);
+        BENCH(name, 10000, fa[0] = i; iec_gt_batch(mask, fa, fb, 4096, IEC_T_REAL));
+    }
+    iec_batch_max_level = IEC_BATCH_AVX2;
+    printf("\n");
+}
+
+static void bench_edge(void) {
+    static iec_t q[10000];
+    iec_t clk = IEC_ALLOC;
+    iec_bool_bank_t bclk, bq;
+    iec_edge_t edge;
+    uint32_t index, sum = 0;
+
+    for (int n = 0; n < 10000; n++) {
+        q[n] = IEC_ALLOC;
+        iec_init(&q[n], IEC_T_BOOL);
+    }
+    iec_init(&clk, IEC_T_BOOL);
+    iec_bool_bank_init(&bclk, 10000);
+    iec_bool_bank_init(&bq, 10000);
+    iec_edge_init(&edge, 10000, false);
+
+    printf("_  BENCH EDGE (10000 inputs, per scan)\n");
+    BENCH("R_TRIG iec_t", 1000, iec_set_value(clk, i & 1); for (int n = 0; n < 10000; n++) iec_r_trig(&q[n], clk));
+    BENCH("R_TRIG batch", 1000, bclk.words[i % 157] ^= i; iec_r_trig_batch(&bq, &edge, &bclk));
+    BENCH("R_TRIG batch + iterate", 1000, bclk.words[i % 157] ^= i; iec_r_trig_batch(&bq, &edge, &bclk);
+            iec_bits_iter_t it; iec_bits_iter_init(&it, bq.words, 10000); while (iec_bits_next(&it, &index)) sum++);
+    printf("  %-32s %8u\n\n", "edges visited", sum);
+
+    for (int n = 0; n < 10000; n++)
+        iec_free(q[n]);
+    iec_free(clk);
+    iec_bool_bank_release(&bclk);
+    iec_bool_bank_release(&bq);
+    iec_edge_release(&edge);
+}
+
+static void bench_timers(void) {
+    static iec_t timer[15000];
+    iec_t in = IEC_ALLOC, pt = IEC_ALLOC, et = NULL;
+    iec_wheel_t wheel;
+    uint32_t id;
+
+    iec_init(&in, IEC_T_BOOL);
+    iec_init(&pt, IEC_T_TIME);
+    iec_set_value(pt, 500);
+    iec_wheel_init(&wheel, 15000, 0);
+    for (int n = 0; n < 15000; n++) {
+        timer[n] = IEC_ALLOC;
+        iec_init(&timer[n], IEC_T_TIMER);
+        iec_wheel_add(&wheel, IEC_WHEEL_TON, 100 + n % 1000, &id);
+    }
+
+    printf("_  BENCH TIMERS (15000 TON, 1%% IN changes, per scan)\n");
+    BENCH("TON iec_t", 1000, iec_set_value(in, (i / 100) & 1); for (int n = 0; n < 15000; n++) iec_ton(&timer[n], in, pt, &et));
+    BENCH("TON wheel", 1000, iec_wheel_advance(&wheel, i); for (int n = i % 100; n < 15000; n += 100)
+            iec_wheel_in(&wheel, n, !wheel.timers[n].in));
+
+    iec_timer_bank_t bank;
+    iec_timer_bank_init(&bank, IEC_TIMER_BANK_TON, 15000);
+    for (int n = 0; n < 15000; n++)
+        bank.pt[n] = 100 + n % 1000;
+    BENCH("TON bank scalar", 1000, iec_batch_max_level = IEC_BATCH_NONE; bank.in[i % 235] ^= i; iec_timer_bank_update(&bank, i));
+    iec_batch_max_level = IEC_BATCH_AVX2;
+    if (iec_batch_level() == IEC_BATCH_AVX2)
+        BENCH("TON bank AVX2", 1000, bank.in[i % 235] ^= i; iec_timer_bank_update(&bank, i));
+    iec_timer_bank_release(&bank);
+    printf("\n");
+
+    for (int n = 0; n < 15000; n++) {
+        iec_free_value(&timer[n]);
+        iec_free(timer[n]);
+    }
+    iec_free(in);
+    iec_free(pt);
+    iec_wheel_release(&wheel);
+}
+
+static void bench_clock(void) {
+    volatile uint64_t sink = 0;
+
+    printf("_  BENCH CLOCK (per call)\n");
+#ifdef __linux__
+    struct timespec ts;
+    BENCH("clock_gettime MONOTONIC", LOOPS / 10, clock_gettime(CLOCK_MONOTONIC, &ts); sink += ts.tv_nsec);
+    BENCH("clock_gettime MONOTONIC_COARSE", LOOPS / 10, clock_gettime(CLOCK_MONOTONIC_COARSE, &ts); sink += ts.tv_nsec);
+#endif
+    BENCH("hw_millis", LOOPS / 10, sink += hw_millis());
+    BENCH("hw_micros", LOOPS / 10, sink += hw_micros());
+#ifdef HW_HAVE_TSC
+    if (hw_tsc_calibrate(HW_TSC_CALIBRATION_MS)) {
+        BENCH("rdtsc", LOOPS / 10, sink += __rdtsc());
+        BENCH("hw_tsc_nanos", LOOPS / 10, sink += hw_tsc_nanos());
+        printf("  %-32s %8" PRId64 " ns\n", "TSC drift", hw_tsc_drift());
+    } else
+        printf("  no invariant TSC\n");
+#endif
+    printf("\n");
+    (void) sink;
+}
+
+static void bench_concat(void) {
+    iec_t piece[20], pair[2], line = IEC_ALLOC, fixed = IEC_ALLOC, part = IEC_ALLOC;
+    char chars[11];
+
+    for (int n = 0; n < 20; n++) {
+        piece[n] = IEC_ALLOC;
+        iec_init(&piece[n], IEC_T_NULL);
+        snprintf(chars, sizeof(chars), "field %03d;", n);
+        iec_string_set(&piece[n], chars, 0, 0);
+    }
+    iec_init(&line, IEC_T_NULL);
+    iec_init(&part, IEC_T_NULL);
+    iec_string_init(&fixed, 255, false);
+
+    printf("_  BENCH CONCAT (20 pieces, 200 characters)\n");
+    BENCH("CONCAT pairwise", LOOPS / 100, iec_move(&line, piece[0]);
+            for (int n = 1; n < 20; n++) { pair[0] = line; pair[1] = piece[n]; iec_string_concat_n(&part, pair, 2); iec_move(&line, part); });
+    BENCH("CONCAT n-ary", LOOPS / 100, iec_string_concat_n(&line, piece, 20));
+    BENCH("CONCAT n-ary STRING[255]", LOOPS / 100, iec_string_concat_n(&fixed, piece, 20));
+    printf("\n");
+
+    for (int n = 0; n < 20; n++)
+        iec_deinit(&piece[n]);
+    iec_deinit(&line);
+    iec_deinit(&fixed);
+    iec_deinit(&part);
+}
+
+static void bench_string_eq(void) {
+    iec_t a = IEC_ALLOC, b = IEC_ALLOC, result = IEC_ALLOC;
+    iec_intern_t intern;
+    char chars[65];
+
+    memset(chars, 'x', 64);
+    chars[64] = '\0';
+    iec_init(&a, IEC_T_NULL);
+    iec_init(&b, IEC_T_NULL);
+    iec_init(&result, IEC_T_BOOL);
+    iec_string_set(&a, chars, 0, 0);
+    chars[63] = 'y';
+    iec_string_set(&b, chars, 0, 0);
+
+    printf("_  BENCH STRING EQ (64 characters)\n");
+    BENCH("EQ different, memcmp", LOOPS, iec_eq(&result, a, b));
+    iec_string_set(&b, chars, 0, 1);
+    chars[63] = 'x';
+    iec_string_set(&a, chars, 0, 1);
+    BENCH("EQ different, hash", LOOPS, iec_eq(&result, a, b));
+    iec_string_set(&b, chars, 0, 0);
+    BENCH("EQ equal, memcmp", LOOPS, iec_eq(&result, a, b));
+    iec_intern_init(&intern, 16);
+    iec_string_intern(&intern, a);
+    iec_string_intern(&intern, b);
+    BENCH("EQ equal, interned", LOOPS, iec_eq(&result, a, b));
+    printf("\n");
+
+    iec_deinit(&a);
+    iec_deinit(&b);
+    iec_deinit(&result);
+    iec_intern_release(&intern);
+}
+
+static void bench_search(void) {
+    static char haystack[8193];
+    const size_t lengths[] = { 256, 8192 };
+    const size_t needles[] = { 1, 4, 16, 64 };
+    volatile uintptr_t sink = 0;
+    uint32_t seed = 1;
+    char name[48];
+
+    printf("_  BENCH SEARCH (needle at end / start for reverse)\n");
+    for (size_t h = 0; h < 2; h++) {
+        size_t length = lengths[h];
+        for (size_t n = 0; n < 4; n++) {
+            size_t needle_length = needles[n];
+            char needle[65];
+            for (size_t i = 0; i < length; i++) {
+                seed = seed * 1103515245 + 12345;
+                haystack[i] = 'a' + (seed >> 16) % 26;
+            }
+            haystack[length] = '\0';
+            memcpy(needle, haystack + length - needle_length, needle_length);
+            needle[needle_length] = '\0';
+            memcpy(haystack, needle, needle_length);
+            haystack[needle_length] = 'a' + (haystack[needle_length] - 'a' + 1) % 26;
+            uint32_t loops = LOOPS / 10 / length * 64;
+
+            snprintf(name, sizeof(name), "strstr %zu/%zu", needle_length, length);
+            BENCH(name, loops, sink += (uintptr_t) strstr(haystack + 1, needle));
+            snprintf(name, sizeof(name), "search_forward %zu/%zu", needle_length, length);
+            BENCH(name, loops, sink += (uintptr_t) search_forward(haystack + 1, length - 1, needle, needle_length));
+            snprintf(name, sizeof(name), "search_reverse %zu/%zu", needle_length, length);
+            BENCH(name, loops, sink += (uintptr_t) search_reverse(haystack, length - 1, needle, needle_length));
+        }
+    }
+    printf("\n");
+    (void) sink;
+}
+
+int main(void) {
+    hw_clock_init();
+    bench_arithmetic(IEC_T_DINT, "DINT");
+    bench_arithmetic(IEC_T_LINT, "LINT");
+    bench_arithmetic(IEC_T_LREAL, "LREAL");
+    bench_batch();
+    bench_edge();
+    bench_timers();
+    bench_clock();
+    bench_concat();
+    bench_string_eq();
+    bench_search();
+
+    return 0;
+}
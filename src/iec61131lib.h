@@ -209,16 +209,41 @@ typedef struct user_t{
     uint32_t value; /**< */
 } user_t;
 
+/**
+ * @def IEC_STRING_SSO
+ * @brief strings up to this length are stored inside string_t
+ *
+ */
+#define IEC_STRING_SSO  22
+
+/**
+ * @typedef iec_slice_t
+ * @brief read only view of part of a string (see iec_string.h)
+ *
+ */
+typedef struct iec_slice_t {
+        struct string_t *parent; /**< viewed string (NULL if not a view) */
+             const char *value;  /**< first character */
+               uint32_t length;  /**< length */
+                   char *owned;  /**< copy made when parent changed */
+    struct iec_slice_t *next;    /**< next view of parent */
+} iec_slice_t;
+
 /**
  * @typedef string_t
  * @brief
  *
  */
 typedef struct string_t {
-        bool wstring; /**< true if wide character type */
-    uint32_t len;     /**< string length*/
-    uint32_t hash;    /**< string hash*/
-       str_t *str;    /**< string pointer*/
+        bool wstring;                   /**< true if wide character type */
+    uint32_t len;                       /**< string length*/
+    uint32_t hash;                      /**< string hash (0: not computed) */
+    uint32_t max;                       /**< max length of STRING[n] (0: not bounded) */
+        bool interned;                  /**< str is the storage of an intern table entry */
+       str_t *str;                      /**< string pointer*/
+       str_t buffer;                    /**< owned storage (buffer.value is NULL if not allocated) */
+        char local[IEC_STRING_SSO + 1]; /**< storage of short strings, no allocation */
+ iec_slice_t *slices;                   /**< live views of storage */
 } string_t;
 
 /**
@@ -254,16 +279,38 @@ typedef struct t_timer_t {
  *
  */
 typedef struct iec_t {
-    iectype_t type;     /**< data type */
-         tt_t tt;       /**< data tt */
-     uint16_t any_type; /**< any type flags */
-        void* value;    /**< data value */
+    iectype_t type;              /**< data type */
+         tt_t tt;                /**< data tt */
+     uint16_t any_type;          /**< any type flags */
+    union {
+             void *value;        /**< out of line data value (see IEC_T_EXTERNAL) */
+             bool v_bool;        /**< BOOL, R_EDGE, F_EDGE */
+           int8_t v_int8;        /**< SINT */
+          uint8_t v_uint8;       /**< USINT, BYTE */
+          int16_t v_int16;       /**< INT */
+         uint16_t v_uint16;      /**< UINT, WORD */
+          int32_t v_int32;       /**< DINT */
+         uint32_t v_uint32;      /**< UDINT, DWORD */
+#ifdef ALLOW_64BITS
+          int64_t v_int64;       /**< LINT, LWORD */
+         uint64_t v_uint64;      /**< ULINT */
+            dat_t v_dat;         /**< DT */
+#endif
+            float v_float;       /**< REAL */
+           double v_double;      /**< LREAL, TIME */
+           date_t v_date;        /**< DATE */
+            tod_t v_tod;         /**< TOD */
+             char v_char;        /**< CHAR */
+          wchar_t v_wchar;       /**< WCHAR */
+        pointer_t v_pointer;     /**< POINTER */
+         uint64_t v_raw;         /**< raw inline payload */
+    };                           /**< inline data value for elementary types */
 } *iec_t;
 
 /**
  * @brief size of types in bits
  */
-static uint8_t IEC_T_SIZEOF[] = {
+static uint16_t IEC_T_SIZEOF[] = {
         0,                     /**< IEC_T_NULL */
         sizeof(bool) * 8,      /**< IEC_T_BOOL */
         sizeof(int8_t) * 8,    /**< IEC_T_SINT */
@@ -308,6 +355,177 @@ static uint8_t IEC_T_SIZEOF[] = {
         0,                     /**< IEC_T_NDEF_1F */
 };
 
+/**
+ * @name type list
+ * @brief all types in code order. X(arg, name, C type, inline member) for types with scalar value, N(arg, name) for
+ *        the others. arg is passed through to build generated identifiers
+ *
+ */
+/**@{*/
+#ifdef ALLOW_64BITS
+#define IEC_TYPES_64(X, N, a)                                                                     \
+            X(a, LINT, int64_t, v_int64) X(a, ULINT, uint64_t, v_uint64) X(a, LWORD, int64_t, v_int64)
+#define IEC_TYPES_DT(X, N, a)       N(a, DT)
+#define IEC_TYPES_POINTER(X, N, a)  X(a, POINTER, pointer_t, v_pointer)
+#else
+#define IEC_TYPES_64(X, N, a)       N(a, NDEF_0B) N(a, NDEF_0C) N(a, NDEF_0D)
+#define IEC_TYPES_DT(X, N, a)       N(a, NDEF_13)
+#define IEC_TYPES_POINTER(X, N, a)  N(a, NDEF_18)
+#endif
+#define IEC_TYPES(X, N, a)                                                                        \
+            N(a, NULL)                                                                            \
+            X(a, BOOL, bool, v_bool)                                                              \
+            X(a, SINT, int8_t, v_int8)                                                            \
+            X(a, USINT, uint8_t, v_uint8)                                                         \
+            X(a, BYTE, uint8_t, v_uint8)                                                          \
+            X(a, INT, int16_t, v_int16)                                                           \
+            X(a, UINT, uint16_t, v_uint16)                                                        \
+            X(a, WORD, uint16_t, v_uint16)                                                        \
+            X(a, DINT, int32_t, v_int32)                                                          \
+            X(a, UDINT, uint32_t, v_uint32)                                                       \
+            X(a, DWORD, uint32_t, v_uint32)                                                       \
+            IEC_TYPES_64(X, N, a)                                                                 \
+            X(a, REAL, float, v_float)                                                            \
+            X(a, LREAL, double, v_double)                                                         \
+            X(a, TIME, double, v_double)                                                          \
+            N(a, DATE)                                                                            \
+            N(a, TOD)                                                                             \
+            IEC_TYPES_DT(X, N, a)                                                                 \
+            X(a, CHAR, char, v_char)                                                              \
+            X(a, WCHAR, wchar_t, v_wchar)                                                         \
+            N(a, STRING)                                                                          \
+            N(a, WSTRING)                                                                         \
+            IEC_TYPES_POINTER(X, N, a)                                                            \
+            N(a, TABLE)                                                                           \
+            N(a, USER)                                                                            \
+            X(a, R_EDGE, bool, v_bool)                                                            \
+            X(a, F_EDGE, bool, v_bool)                                                            \
+            N(a, TIMER)                                                                           \
+            N(a, NDEF_1E)                                                                         \
+            N(a, NDEF_1F)
+#define IEC_TYPES_COUNT             0x20
+#define IEC_TYPE_FN(fn, name, type, member)  fn ## _ ## name,
+#define IEC_TYPE_FN_NONE(fn, name)           fn ## _none,
+/**@}*/
+
+/**
+ * @name scalar load and store
+ * @brief one function per type, to read/write an inline value as signed, unsigned or floating C type.
+ *        Values are converted with C rules
+ *
+ */
+/**@{*/
+#define IEC_LOAD_STORE(a, name, type, member)                                                                        \
+static int64_t  iec_load_i64_ ## name(const void *p)        { return (int64_t) *((const type*) p); }                 \
+static uint64_t iec_load_u64_ ## name(const void *p)        { return (uint64_t) *((const type*) p); }                \
+static double   iec_load_f64_ ## name(const void *p)        { return (double) *((const type*) p); }                  \
+static void     iec_store_i64_ ## name(void *p, int64_t v)  { *((type*) p) = (type) v; }                             \
+static void     iec_store_u64_ ## name(void *p, uint64_t v) { *((type*) p) = (type) v; }                             \
+static void     iec_store_f64_ ## name(void *p, double v)   { *((type*) p) = (type) v; }
+#define IEC_LOAD_STORE_NONE(a, name)
+
+IEC_TYPES(IEC_LOAD_STORE, IEC_LOAD_STORE_NONE, )
+
+static int64_t  iec_load_i64_none(const void *p)        { (void) p; return 0; }
+static uint64_t iec_load_u64_none(const void *p)        { (void) p; return 0; }
+static double   iec_load_f64_none(const void *p)        { (void) p; return 0; }
+static void     iec_store_i64_none(void *p, int64_t v)  { (void) p; (void) v; }
+static void     iec_store_u64_none(void *p, uint64_t v) { (void) p; (void) v; }
+static void     iec_store_f64_none(void *p, double v)   { (void) p; (void) v; }
+
+static  int64_t (*const IEC_LOAD_I64[])(const void *p)        = { IEC_TYPES(IEC_TYPE_FN, IEC_TYPE_FN_NONE, iec_load_i64) };
+static uint64_t (*const IEC_LOAD_U64[])(const void *p)        = { IEC_TYPES(IEC_TYPE_FN, IEC_TYPE_FN_NONE, iec_load_u64) };
+static   double (*const IEC_LOAD_F64[])(const void *p)        = { IEC_TYPES(IEC_TYPE_FN, IEC_TYPE_FN_NONE, iec_load_f64) };
+static     void (*const IEC_STORE_I64[])(void *p, int64_t v)  = { IEC_TYPES(IEC_TYPE_FN, IEC_TYPE_FN_NONE, iec_store_i64) };
+static     void (*const IEC_STORE_U64[])(void *p, uint64_t v) = { IEC_TYPES(IEC_TYPE_FN, IEC_TYPE_FN_NONE, iec_store_u64) };
+static     void (*const IEC_STORE_F64[])(void *p, double v)   = { IEC_TYPES(IEC_TYPE_FN, IEC_TYPE_FN_NONE, iec_store_f64) };
+
+#define IEC_VALUE_SIZE_X(a, name, type, member) sizeof(type),
+#define IEC_VALUE_SIZE_N(a, name)               0,
+/**
+ * @brief size in bytes of scalar value of types (0 if not scalar)
+ */
+static const uint8_t IEC_VALUE_SIZE[] = { IEC_TYPES(IEC_VALUE_SIZE_X, IEC_VALUE_SIZE_N, ) };
+
+_Static_assert(sizeof(IEC_LOAD_I64) / sizeof(IEC_LOAD_I64[0]) == IEC_TYPES_COUNT, "IEC_TYPES must list all type codes");
+/**@}*/
+
+/**
+ * @def IEC_THREAD_LOCAL
+ * @brief storage class for per thread (context) data. Define as empty on targets without thread local storage
+ *
+ */
+#ifndef IEC_THREAD_LOCAL
+#define IEC_THREAD_LOCAL   _Thread_local
+#endif
+
+/**
+ * @typedef iec_allocator_t
+ * @brief memory allocator used for iec_t containers and out of line values
+ *
+ */
+typedef struct iec_allocator_t {
+    void* (*alloc)(void *ctx, size_t size); /**< allocate size bytes */
+     void (*free)(void *ctx, void *ptr);    /**< release memory returned by alloc */
+     void *ctx;                             /**< allocator context */
+} iec_allocator_t;
+
+/**
+ * @brief number of system heap allocations done by the library in this thread, pool and arena fallbacks included
+ */
+static IEC_THREAD_LOCAL uint32_t iec_heap_allocs = 0;
+
+/**
+ * @fn static void* iec_system_alloc(void *ctx, size_t size)
+ * @brief system heap allocator
+ *
+ * @param ctx
+ * @param size
+ * @return pointer to memory
+ */
+static void* iec_system_alloc(void *ctx, size_t size) {
+    (void) ctx;
+    iec_heap_allocs++;
+    return malloc(size);
+}
+
+/**
+ * @fn static void iec_system_free(void *ctx, void *ptr)
+ * @brief system heap release
+ *
+ * @param ctx
+ * @param ptr
+ */
+static void iec_system_free(void *ctx, void *ptr) {
+    (void) ctx;
+    free(ptr);
+}
+
+/**
+ * @brief default allocator (system heap)
+ */
+static iec_allocator_t iec_allocator_system = { iec_system_alloc, iec_system_free, NULL };
+
+/**
+ * @brief global allocator
+ */
+static iec_allocator_t *iec_allocator = &iec_allocator_system;
+
+/**
+ * @brief context (thread) allocator. If not NULL overrides global allocator
+ */
+static IEC_THREAD_LOCAL iec_allocator_t *iec_allocator_context = NULL;
+
+/**
+ * @typedef iec_alloc_tag_t
+ * @brief header of every block: allocator that returned the block, so it is released there
+ *
+ */
+typedef union iec_alloc_tag_t {
+    iec_allocator_t *owner; /**< allocator in use at iec_malloc */
+        max_align_t align;  /**< keep block aligned */
+} iec_alloc_tag_t;
+
 ///////////////////////////// MACROS ///////////////////////////
 
 /**
@@ -320,7 +538,20 @@ static uint8_t IEC_T_SIZEOF[] = {
 #define CONCAT_INNER(a, b)    a ## b
 #define LABEL(base,x)         CONCAT(base, x)
 #define sign(x)               (((x) > 0) - ((x) < 0))
-#define IEC_ALLOC             malloc(sizeof(struct iec_t))
+#define IEC_ALLOC             iec_malloc(sizeof(struct iec_t))
+#define IEC_ALLOCATOR         (iec_allocator_context != NULL ? iec_allocator_context : iec_allocator)
+/**@}*/
+
+/**
+ * @name util allocators
+ * @brief route allocations of utils to library allocator
+ *
+ */
+/**@{*/
+#define STACK_MALLOC(size)    iec_malloc(size)
+#define STACK_FREE(ptr)       iec_free(ptr)
+#define POOL_HEAP_MALLOC(size)  iec_system_alloc(NULL, size)
+#define ARENA_HEAP_MALLOC(size) iec_system_alloc(NULL, size)
 /**@}*/
 
 /**
@@ -354,6 +585,13 @@ static uint8_t IEC_T_SIZEOF[] = {
 #define ANY_CHARS(x)          (ANY_CHAR(x) || ANY_STRING(x))
 /**@}*/
 
+/**
+ * @def IEC_T_EXTERNAL
+ * @brief true if type payload is out of line (allocated and referenced by value). All other types are stored inline in iec_t
+ *
+ */
+#define IEC_T_EXTERNAL(x)     (ANY_STRING(x) || x == IEC_T_TABLE || x == IEC_T_USER || x == IEC_T_TIMER)
+
 /**
  * @name any type bit
  * @brief
@@ -440,183 +678,103 @@ static uint8_t IEC_T_SIZEOF[] = {
             (a)->type > (b)->type ? 0 : 1
 
 /**
- * @name iec_get_value
- * @brief
+ * @name maxuint_t
+ * @brief widest unsigned integer
  *
  */
 /**@{*/
-#define iec_get_value(data)                                                         \
-            ((data)->type == IEC_T_BOOL)                                            \
-              || ((data)->type == IEC_T_R_EDGE)                                     \
-              || ((data)->type == IEC_T_F_EDGE)  ? *((bool*)((data)->value))      : \
-            ((data)->type == IEC_T_SINT)         ? *((int8_t*)((data)->value))    : \
-            ((data)->type == IEC_T_USINT                                            \
-              || (data)->type == IEC_T_BYTE)     ? *((uint8_t*)((data)->value))   : \
-            ((data)->type == IEC_T_INT)          ? *((int16_t*)((data)->value))   : \
-            ((data)->type == IEC_T_UINT)                                            \
-              || ((data)->type == IEC_T_WORD)    ? *((uint16_t*)((data)->value))  : \
-            ((data)->type == IEC_T_DINT)         ? *((int32_t*)((data)->value))   : \
-            ((data)->type == IEC_T_UDINT)                                           \
-              || ((data)->type == IEC_T_DWORD)   ? *((uint32_t*)((data)->value))  : \
-            ((data)->type == IEC_T_REAL)         ? *((float*)((data)->value))     : \
-            ((data)->type == IEC_T_TIME)                                            \
-              || ((data)->type == IEC_T_LREAL)   ? *((double*)((data)->value))    : \
-            GV_64(data)
 #ifdef ALLOW_64BITS
-#define GV_64(data)                                                                 \
-            ((data)->type == IEC_T_ULINT)      ? *((uint64_t*)((data)->value))    : \
-            ((data)->type == IEC_T_LINT)                                            \
-              || ((data)->type == IEC_T_LWORD) ? *((int64_t*)((data)->value))     : \
-            ((data)->type == IEC_T_POINTER)    ? *((pointer_t*)((data)->value))   : \
-            0
+#define maxuint_t  uint64_t
 #else
-#define GV_64(data) 0
+#define maxuint_t uint32_t
 #endif
 /**@}*/
 
+/**
+ * @name iec_get_value
+ * @brief read scalar value. iec_get_int/uint/real are exact for their C type, iec_get_value returns double and
+ *        loses precision of 64 bits integers: pick the accessor by type class (see iec_compare)
+ *
+ */
+/**@{*/
+#define iec_get_int(data)                (IEC_LOAD_I64[(data)->type](&(data)->value))
+#define iec_get_uint(data)               (IEC_LOAD_U64[(data)->type](&(data)->value))
+#define iec_get_real(data)               (IEC_LOAD_F64[(data)->type](&(data)->value))
+#define iec_get_value(data)              iec_get_real(data)
+/**@}*/
+
+/**
+ * @def IEC_VALUE_REAL
+ * @brief true if value of data is stored as floating point (ANY_REAL and TIME)
+ *
+ */
+#define IEC_VALUE_REAL(data)  (((data)->any_type & ANY_REAL_BIT) || (data)->type == IEC_T_TIME)
+
+/**
+ * @def IEC_CMP_UNORDERED
+ * @brief iec_compare result if a floating operand is NaN
+ *
+ */
+#define IEC_CMP_UNORDERED 2
+
+/**
+ * @fn static inline int iec_compare(iec_t a, iec_t b)
+ * @brief order of scalar values. In double if one of them is floating, else exact in integers: int64_t if both
+ *        are ANY_SIGNED, uint64_t if none is, and a negative signed value is below any unsigned one
+ *
+ * @param a
+ * @param b
+ * @return -1 (a < b), 0 (a = b), 1 (a > b) or IEC_CMP_UNORDERED
+ */
+static inline int iec_compare(iec_t a, iec_t b) {
+    if (IEC_VALUE_REAL(a) || IEC_VALUE_REAL(b)) {
+        double x = iec_get_real(a), y = iec_get_real(b);
+        return x < y ? -1 : x > y ? 1 : x == y ? 0 : IEC_CMP_UNORDERED;
+    }
+
+    bool a_signed = a->any_type & ANY_SIGNED_BIT;
+    bool b_signed = b->any_type & ANY_SIGNED_BIT;
+    if (a_signed && b_signed) {
+        int64_t x = iec_get_int(a), y = iec_get_int(b);
+        return (x > y) - (x < y);
+    }
+    if (a_signed && iec_get_int(a) < 0)
+        return -1;
+    if (b_signed && iec_get_int(b) < 0)
+        return 1;
+
+    uint64_t x = iec_get_uint(a), y = iec_get_uint(b);
+    return (x > y) - (x < y);
+}
+
 /**
  * @name iec_get_value_type
- * @brief
+ * @brief read scalar value of type from pointer
  *
  */
 /**@{*/
-#define iec_get_value_type(data, type)                                       \
-            (type == IEC_T_BOOL)                                             \
-              || (type == IEC_T_R_EDGE)                                      \
-              || (type == IEC_T_F_EDGE)  ? *((bool*)(data))               : \
-            (type == IEC_T_SINT)         ? *((int8_t*)((data)))            : \
-            (type == IEC_T_USINT                                             \
-              || type == IEC_T_BYTE)     ? *((uint8_t*)((data)))           : \
-            (type == IEC_T_INT)          ? *((int16_t*)((data)))           : \
-            (type == IEC_T_UINT)                                             \
-              || (type == IEC_T_WORD)    ? *((uint16_t*)((data)))          : \
-            (type == IEC_T_DINT)         ? *((int32_t*)((data)))           : \
-            (type == IEC_T_UDINT)                                            \
-              || (type == IEC_T_DWORD)   ? *((uint32_t*)((data)))          : \
-            (type == IEC_T_REAL)         ? *((float*)((data)))             : \
-            (type == IEC_T_TIME)                                             \
-              || (type == IEC_T_LREAL)   ? *((double*)((data)))            : \
-            GVT_64(data, type)
-#ifdef ALLOW_64BITS
-#define GVT_64(data, type)                                                   \
-            (type == IEC_T_ULINT)      ? *((uint64_t*)((data)))            : \
-            (type == IEC_T_LINT)                                             \
-              || (type == IEC_T_LWORD) ? *((int64_t*)((data)))             : \
-            (type == IEC_T_POINTER)    ? *((pointer_t*)((data)))           : \
-            0
-#else
-#define GVT_64(data, type) 0
-#endif
+#define iec_get_value_type(data, type)   (IEC_LOAD_F64[(type)](data))
 /**@}*/
 
 /**
  * @name iec_get_valuep
- * @brief
+ * @brief pointer to value
  *
  */
 /**@{*/
-#define iec_get_valuep(data)                                                     \
-            ((data)->type == IEC_T_BOOL)                                         \
-			  || ((data)->type == IEC_T_R_EDGE)                                  \
-			  || ((data)->type == IEC_T_F_EDGE)  ? ((bool*)(data)->value)      : \
-            ((data)->type == IEC_T_SINT)         ? ((int8_t*)(data)->value)    : \
-            ((data)->type == IEC_T_USINT                                         \
-              || (data)->type == IEC_T_BYTE)     ? ((uint8_t*)(data)->value)   : \
-            ((data)->type == IEC_T_INT)          ? ((int16_t*)(data)->value)   : \
-            ((data)->type == IEC_T_UINT)                                         \
-              || ((data)->type == IEC_T_WORD)    ? ((uint16_t*)(data)->value)  : \
-            ((data)->type == IEC_T_DINT)         ? ((int32_t*)(data)->value)   : \
-            ((data)->type == IEC_T_UDINT)                                        \
-              || ((data)->type == IEC_T_DWORD)   ? ((uint32_t*)(data)->value)  : \
-            ((data)->type == IEC_T_REAL)         ? ((float*)(data)->value)     : \
-            ((data)->type == IEC_T_TIME)         ? ((double*)(data)->value)    : \
-            ((data)->type == IEC_T_LREAL)        ? ((double*)(data)->value)    : \
-            GVP_64(data)
-#ifdef ALLOW_64BITS
-#define GVP_64(data)                                                             \
-            ((data)->type == IEC_T_ULINT)      ? ((uint64_t*)(data)->value)    : \
-            ((data)->type == IEC_T_LINT)                                         \
-              || ((data)->type == IEC_T_LWORD) ? ((int64_t*)(data)->value)     : \
-            ((data)->type == IEC_T_POINTER)    ? ((pointer_t*)(data)->value)   : \
-            0
-#else
-#define GVP_64(data) 0
-#endif
+#define iec_get_valuep(data)             (IEC_T_EXTERNAL((data)->type) ? (data)->value : (void*) &(data)->value)
 /**@}*/
 
 /**
  * @name iec_get_tovoid
- * @brief
+ * @brief declare var as pointer to a copy of scalar value
  *
  */
 /**@{*/
-#define iec_get_tovoid(data, var)                                          \
-		    maxuint_t CONCAT(var, _) = 0;                                  \
-		    void *var = &CONCAT(var, _);                                   \
-            switch ((data)->type) {                                        \
-                case IEC_T_F_EDGE:                                         \
-                case IEC_T_R_EDGE:                                         \
-                case IEC_T_BOOL:                                           \
-                    *((bool*)(var)) = *((bool*)((data)->value));           \
-                    break;                                                 \
-                case IEC_T_SINT:                                           \
-                    *((int8_t*)(var)) = *((int8_t*)((data)->value));       \
-                    break;                                                 \
-                case IEC_T_USINT:                                          \
-                case IEC_T_BYTE:                                           \
-                    *((uint8_t*)(var)) = *((uint8_t*)((data)->value));     \
-                    break;                                                 \
-                case IEC_T_INT:                                            \
-                    *((int16_t*)(var)) = *((int16_t*)((data)->value));     \
-                    break;                                                 \
-                case IEC_T_UINT:                                           \
-                case IEC_T_WORD:                                           \
-                    *((uint16_t*)(var)) = *((uint16_t*)((data)->value));   \
-                    break;                                                 \
-                case IEC_T_DINT:                                           \
-                    *((int32_t*)(var)) = *((int32_t*)((data)->value));     \
-                    break;                                                 \
-                case IEC_T_UDINT:                                          \
-                case IEC_T_DWORD:                                          \
-                    *((uint32_t*)(var)) = *((uint32_t*)((data)->value));   \
-                    break;                                                 \
-                case IEC_T_REAL:                                           \
-                    *((float*)(var)) = *((float*)((data)->value));         \
-                    break;                                                 \
-                case IEC_T_LREAL:                                          \
-                    *((double*)(var)) = *((double*)((data)->value));       \
-                    break;                                                 \
-                case IEC_T_TIME:                                           \
-                    *((double*)(var)) = *((double*)((data)->value));       \
-                    break;                                                 \
-                case IEC_T_CHAR:                                           \
-                    *((char*)(var)) = *((char*)((data)->value));           \
-                    break;                                                 \
-                case IEC_T_WCHAR:                                          \
-                    *((wchar_t*)(var)) = *((wchar_t*)((data)->value));     \
-                    break;                                                 \
-                GTV_64(data, var)                                          \
-                default:                                                   \
-                    *((bool*)(var)) = 0;                                   \
-                    break;                                                 \
-            }
-#ifdef ALLOW_64BITS
-#define GTV_64(data, var)                                                  \
-            case IEC_T_ULINT:                                              \
-                *((uint64_t*)(var)) = *((uint64_t*)((data)->value));       \
-                break;                                                     \
-            case IEC_T_LINT:                                               \
-            case IEC_T_LWORD:                                              \
-                *((int64_t*)(var)) = *((int64_t*)((data)->value));         \
-                break;                                                     \
-            case IEC_T_POINTER:                                            \
-                *((pointer_t*)(var)) = *((pointer_t*)((data)->value));     \
-                break;
-#define maxuint_t  uint64_t
-#else
-#define GTV_64(data, var)
-#define maxuint_t uint32_t
-#endif
+#define iec_get_tovoid(data, var)                                               \
+            maxuint_t CONCAT(var, _) = 0;                                       \
+            void *var = &CONCAT(var, _);                                        \
+            memcpy(var, &(data)->value, IEC_VALUE_SIZE[(data)->type])
 /**@}*/
 
 /**
@@ -628,212 +786,40 @@ static uint8_t IEC_T_SIZEOF[] = {
 
 /**
  * @name iec_set_value
- * @brief
+ * @brief write scalar value. The store function is selected by C type of val, so integers are not converted to double
  *
  */
 /**@{*/
-#define iec_set_value(data, val)                          \
-            switch ((data)->type) {                       \
-                case IEC_T_F_EDGE:                        \
-                case IEC_T_R_EDGE:                        \
-                case IEC_T_BOOL:                          \
-				    *((bool*)((data)->value)) = val;      \
-                    break;                                \
-                case IEC_T_SINT:                          \
-                    *((int8_t*)((data)->value)) = val;    \
-                    break;                                \
-                case IEC_T_USINT:                         \
-                case IEC_T_BYTE:                          \
-                    *((uint8_t*)((data)->value)) = val;   \
-                    break;                                \
-                case IEC_T_INT:                           \
-                    *((int16_t*)((data)->value)) = val;   \
-                    break;                                \
-                case IEC_T_UINT:                          \
-                case IEC_T_WORD:                          \
-                    *((uint16_t*)((data)->value)) = val;  \
-                    break;                                \
-                case IEC_T_DINT:                          \
-                    *((int32_t*)((data)->value)) = val;   \
-                    break;                                \
-                case IEC_T_UDINT:                         \
-                case IEC_T_DWORD:                         \
-                    *((uint32_t*)((data)->value)) = val;  \
-                    break;                                \
-                case IEC_T_REAL:                          \
-				    *((float*)((data)->value)) = val;     \
-				    break;                                \
-                case IEC_T_LREAL:                         \
-                    *((double*)((data)->value)) = val;    \
-                    break;                                \
-                case IEC_T_TIME:                          \
-                    *((double*)((data)->value)) = val;    \
-                    break;                                \
-                case IEC_T_CHAR:                          \
-                    *((char*)((data)->value)) = val;      \
-                    break;                                \
-                case IEC_T_WCHAR:                         \
-                    *((wchar_t*)((data)->value)) = val;   \
-                    break;                                \
-                SV_64(data, val)                          \
-                default:                                  \
-                    (data)->value = NULL;                 \
-            }
-#ifdef ALLOW_64BITS
-#define SV_64(data, val)                                  \
-            case IEC_T_ULINT:                             \
-                *((uint64_t*)((data)->value)) = val;      \
-                break;                                    \
-            case IEC_T_LINT:                              \
-            case IEC_T_LWORD:                             \
-                *((int64_t*)((data)->value)) = val;       \
-                break;                                    \
-            case IEC_T_POINTER:                           \
-                *((pointer_t*)((data)->value)) = val;     \
-                break;
-#else
-#define SV_64(data, val)
-#endif
+#define iec_store_fn(type, val)                                                 \
+            _Generic((val),                                                     \
+                float:              IEC_STORE_F64[(type)],                      \
+                double:             IEC_STORE_F64[(type)],                      \
+                long double:        IEC_STORE_F64[(type)],                      \
+                unsigned long:      IEC_STORE_U64[(type)],                      \
+                unsigned long long: IEC_STORE_U64[(type)],                      \
+                default:            IEC_STORE_I64[(type)])
+#define iec_set_value(data, val)         iec_store_fn((data)->type, val)(&(data)->value, (val))
+#define iec_set_int(data, val)           IEC_STORE_I64[(data)->type](&(data)->value, (val))
+#define iec_set_uint(data, val)          IEC_STORE_U64[(data)->type](&(data)->value, (val))
+#define iec_set_real(data, val)          IEC_STORE_F64[(data)->type](&(data)->value, (val))
 /**@}*/
 
 /**
  * @name iec_set_value_type
- * @brief
+ * @brief write scalar value of type to pointer
  *
  */
 /**@{*/
-#define iec_set_value_type(data, val, type)     \
-            switch (type) {                     \
-                case IEC_T_F_EDGE:              \
-                case IEC_T_R_EDGE:              \
-                case IEC_T_BOOL:                \
-                    *((bool*)(data)) = val;     \
-                    break;                      \
-                case IEC_T_SINT:                \
-                    *((int8_t*)(data)) = val;   \
-                    break;                      \
-                case IEC_T_USINT:               \
-                case IEC_T_BYTE:                \
-                    *((uint8_t*)(data)) = val;  \
-                    break;                      \
-                case IEC_T_INT:                 \
-                    *((int16_t*)(data)) = val;  \
-                    break;                      \
-                case IEC_T_UINT:                \
-                case IEC_T_WORD:                \
-                    *((uint16_t*)(data)) = val; \
-                    break;                      \
-                case IEC_T_DINT:                \
-                    *((int32_t*)(data)) = val;  \
-                    break;                      \
-                case IEC_T_UDINT:               \
-                case IEC_T_DWORD:               \
-                    *((uint32_t*)(data)) = val; \
-                    break;                      \
-                case IEC_T_REAL:                \
-                    *((float*)(data)) = val;    \
-                    break;                      \
-                case IEC_T_LREAL:               \
-                    *((double*)(data)) = val;   \
-                    break;                      \
-                case IEC_T_TIME:                \
-                    *((double*)(data)) = val;   \
-                    break;                      \
-                case IEC_T_CHAR:                \
-                    *((char*)(data)) = val;     \
-                    break;                      \
-                case IEC_T_WCHAR:               \
-                    *((wchar_t*)(data)) = val;  \
-                    break;                      \
-                SVT_64(data, val)               \
-                default:                        \
-                    (data) = NULL;              \
-            }
-#ifdef ALLOW_64BITS
-#define SVT_64(data, val)                       \
-            case IEC_T_ULINT:                   \
-                *((uint64_t*)(data)) = val;     \
-                break;                          \
-            case IEC_T_LINT:                    \
-            case IEC_T_LWORD:                   \
-                *((int64_t*)(data)) = val;      \
-                break;                          \
-            case IEC_T_POINTER:                 \
-                *((pointer_t*)(data)) = val;    \
-                break;
-#else
-#define SVT_64(data, val)
-#endif
+#define iec_set_value_type(data, val, type)  iec_store_fn(type, val)((data), (val))
 /**@}*/
 
 /**
  * @name iec_set_fromvoid
- * @brief
+ * @brief write scalar value from pointer to value of same type
  *
  */
 /**@{*/
-#define iec_set_fromvoid(data, val)                                     \
-            switch ((data)->type) {                                     \
-                case IEC_T_F_EDGE:                                      \
-                case IEC_T_R_EDGE:                                      \
-                case IEC_T_BOOL:                                        \
-                    *((bool*)((data)->value)) = *((bool*)val);          \
-                    break;                                              \
-                case IEC_T_SINT:                                        \
-                    *((int8_t*)((data)->value)) = *((int8_t*)val);      \
-                    break;                                              \
-                case IEC_T_USINT:                                       \
-                case IEC_T_BYTE:                                        \
-                    *((uint8_t*)((data)->value)) = *((uint8_t*)val);    \
-                    break;                                              \
-                case IEC_T_INT:                                         \
-                    *((int16_t*)((data)->value)) = *((int16_t*)val);    \
-                    break;                                              \
-                case IEC_T_UINT:                                        \
-                case IEC_T_WORD:                                        \
-                    *((uint16_t*)((data)->value)) = *((uint16_t*)val);  \
-                    break;                                              \
-                case IEC_T_DINT:                                        \
-                    *((int32_t*)((data)->value)) = *((int32_t*)val);    \
-                    break;                                              \
-                case IEC_T_UDINT:                                       \
-                case IEC_T_DWORD:                                       \
-                    *((uint32_t*)((data)->value)) = *((uint32_t*)val);  \
-                    break;                                              \
-                case IEC_T_REAL:                                        \
-                    *((float*)((data)->value)) = *((float*)val);        \
-                    break;                                              \
-                case IEC_T_LREAL:                                       \
-                    *((double*)((data)->value)) = *((double*)val);      \
-                    break;                                              \
-                case IEC_T_TIME:                                        \
-                    *((double*)((data)->value)) = *((double*)val);      \
-                    break;                                              \
-                case IEC_T_CHAR:                                        \
-                    *((char*)((data)->value)) = *((char*)val);          \
-                    break;                                              \
-                case IEC_T_WCHAR:                                       \
-                    *((wchar_t*)((data)->value)) = *((wchar_t*)val);    \
-                    break;                                              \
-                SFV_64                                                  \
-                default:                                                \
-                    (data)->value = NULL;                               \
-            }
-#ifdef ALLOW_64BITS
-#define SFV_64                                                          \
-            case IEC_T_ULINT:                                           \
-                *((uint64_t*)((data)->value)) = *((uint64_t*)val);      \
-                break;                                                  \
-            case IEC_T_LINT:                                            \
-            case IEC_T_LWORD:                                           \
-                *((int64_t*)((data)->value)) = *((int64_t*)val);        \
-                break;                                                  \
-            case IEC_T_POINTER:                                         \
-                *((pointer_t*)((data)->value)) = *((pointer_t*)val);    \
-                break;
-#else
-#define SFV_64
-#endif
+#define iec_set_fromvoid(data, val)      memcpy(&(data)->value, (val), IEC_VALUE_SIZE[(data)->type])
 /**@}*/
 
 /**
@@ -916,112 +902,114 @@ static uint8_t IEC_T_SIZEOF[] = {
 ////////////////////////////////////////////////////////////////
 
 /**
- * @fn static inline void iec_new_value(void **nw, iectype_t type)
- * @brief
+ * @fn static inline void iec_set_allocator(iec_allocator_t *allocator)
+ * @brief install allocator. NULL restores system heap allocator.
+ *        Blocks are released to the allocator that returned them, so it must outlive them (static object)
+ *
+ * @param allocator
+ */
+static inline void iec_set_allocator(iec_allocator_t *allocator) {
+    iec_allocator = allocator != NULL ? allocator : &iec_allocator_system;
+}
+
+/**
+ * @fn static inline void iec_set_context_allocator(iec_allocator_t *allocator)
+ * @brief install allocator for the calling thread only. NULL restores global allocator.
+ *        Blocks are released to the allocator that returned them, so it must outlive them (static object)
+ *
+ * @param allocator
+ */
+static inline void iec_set_context_allocator(iec_allocator_t *allocator) {
+    iec_allocator_context = allocator;
+}
+
+/**
+ * @fn static inline uint32_t iec_heap_allocations(void)
+ * @brief number of system heap allocations done by the library in calling thread. Counts the system allocator and
+ *        the fallbacks of pool and arena allocators, so it must not change in real time code
+ *
+ * @return count
+ */
+static inline uint32_t iec_heap_allocations(void) {
+    return iec_heap_allocs;
+}
+
+/**
+ * @fn static inline void* iec_malloc(size_t size)
+ * @brief allocate from allocator in use. The block is tagged with the allocator
+ *
+ * @param size
+ * @return pointer to memory
+ */
+static inline void* iec_malloc(size_t size) {
+    iec_allocator_t *allocator = IEC_ALLOCATOR;
+    iec_alloc_tag_t *tag = allocator->alloc(allocator->ctx, sizeof(iec_alloc_tag_t) + size);
+    if (tag == NULL)
+        return NULL;
+    tag->owner = allocator;
+
+    return tag + 1;
+}
+
+/**
+ * @fn static inline void iec_free(void *ptr)
+ * @brief release to the allocator that returned the block, whatever allocator is in use now
+ *
+ * @param ptr
+ */
+static inline void iec_free(void *ptr) {
+    if (ptr == NULL)
+        return;
+
+    iec_alloc_tag_t *tag = (iec_alloc_tag_t*) ptr - 1;
+    tag->owner->free(tag->owner->ctx, tag);
+}
+
+/**
+ * @fn static inline size_t iec_external_size(iectype_t type)
+ * @brief size in bytes of out of line value (0 for inline types)
  *
- * @param nw
  * @param type
+ * @return size
  */
-static inline void iec_new_value(void **nw, iectype_t type) {
+static inline size_t iec_external_size(iectype_t type) {
     switch (type) {
-        case IEC_T_F_EDGE:
-        case IEC_T_R_EDGE:
-        case IEC_T_BOOL:
-            (*nw) = malloc(sizeof(bool));
-            break;
-
-        case IEC_T_SINT:
-            (*nw) = malloc(sizeof(int8_t));
-            break;
-
-        case IEC_T_USINT:
-        case IEC_T_BYTE:
-            (*nw) = malloc(sizeof(uint8_t));
-            break;
-
-        case IEC_T_INT:
-            (*nw) = malloc(sizeof(int16_t));
-            break;
-
-        case IEC_T_UINT:
-        case IEC_T_WORD:
-            (*nw) = malloc(sizeof(uint16_t));
-            break;
-
-        case IEC_T_DINT:
-            (*nw) = malloc(sizeof(int32_t));
-            break;
-
-        case IEC_T_UDINT:
-        case IEC_T_DWORD:
-            (*nw) = malloc(sizeof(uint32_t));
-            break;
-
-        case IEC_T_REAL:
-            (*nw) = malloc(sizeof(float));
-            break;
-
-        case IEC_T_LREAL:
-            (*nw) = malloc(sizeof(double));
-            break;
-
-        case IEC_T_TIME:
-            (*nw) = malloc(sizeof(double));
-            break;
-
-        case IEC_T_DATE:
-            (*nw) = malloc(sizeof(date_t));
-            break;
-
-        case IEC_T_TOD:
-            (*nw) = malloc(sizeof(tod_t));
-            break;
-
-        case IEC_T_CHAR:
-            (*nw) = malloc(sizeof(char));
-            break;
-
-        case IEC_T_WCHAR:
-            (*nw) = malloc(sizeof(wchar_t));
-            break;
-
         case IEC_T_STRING:
         case IEC_T_WSTRING:
-            (*nw) = malloc(sizeof(string_t));
-            break;
-#ifdef ALLOW_64BITS
-        case IEC_T_DT:
-            (*nw) = malloc(sizeof(dat_t));
-            break;
-
-        case IEC_T_ULINT:
-            (*nw) = malloc(sizeof(uint64_t));
-            break;
-
-        case IEC_T_LINT:
-        case IEC_T_LWORD:
-            (*nw) = malloc(sizeof(int64_t));
-            break;
-#endif
-        case IEC_T_POINTER:
-            (*nw) = malloc(sizeof(pointer_t));
-            break;
+            return sizeof(string_t);
 
         case IEC_T_TABLE:
-            (*nw) = malloc(sizeof(table_t));
-            break;
+            return sizeof(table_t);
 
         case IEC_T_USER:
-            (*nw) = malloc(sizeof(user_t));
-            break;
+            return sizeof(user_t);
+
         case IEC_T_TIMER:
-            (*nw) = malloc(sizeof(t_timer_t));
-            break;
+            return sizeof(t_timer_t);
 
         default:
-            (*nw) = NULL;
-            break;
+            return 0;
+    }
+}
+
+/**
+ * @fn static inline void iec_new_value(void **nw, iectype_t type)
+ * @brief allocate out of line value. Inline types (see IEC_T_EXTERNAL) don't need allocation
+ *
+ * @param nw
+ * @param type
+ */
+static inline void iec_new_value(void **nw, iectype_t type) {
+    size_t size = iec_external_size(type);
+
+    if (size == 0) {
+        (*nw) = NULL;
+        return;
     }
+
+    (*nw) = iec_malloc(size);
+    if ((*nw) != NULL)
+        memset((*nw), 0, size);
 }
 
 /**
@@ -1035,9 +1023,33 @@ static inline void iec_init(iec_t *nw, iectype_t type) {
     (*nw)->type = type;
     (*nw)->any_type = IEC_ANYTYPE(type);
     (*nw)->tt = 0;
+    (*nw)->v_raw = 0;
     iec_new_value(&((*nw)->value), type);
 }
 
+/**
+ * @fn static inline void iec_string_detach(string_t *str)
+ * @brief give own copy to views of str before its storage changes
+ *
+ * @param str
+ */
+static inline void iec_string_detach(string_t *str) {
+    while (str->slices != NULL) {
+        iec_slice_t *slice = str->slices;
+        char *owned = slice->length > 0 ? iec_malloc(slice->length) : NULL;
+
+        if (owned != NULL)
+            memcpy(owned, slice->value, slice->length);
+        else
+            slice->length = 0;
+        slice->owned = owned;
+        slice->value = owned != NULL ? owned : "";
+        slice->parent = NULL;
+        str->slices = slice->next;
+        slice->next = NULL;
+    }
+}
+
 /**
  * @fn static inline void iec_free_value(iec_t *var)
  * @brief
@@ -1047,8 +1059,15 @@ static inline void iec_init(iec_t *nw, iectype_t type) {
 static inline void iec_free_value(iec_t *var) {
     if ((*var) == NULL)
         return;
-    if ((*var)->type != IEC_T_NULL)
-        free((*var)->value);
+    if (ANY_STRING((*var)->type) && (*var)->value != NULL) {
+        string_t *str = (string_t*) ((*var)->value);
+        iec_string_detach(str);
+        if (str->buffer.value != str->local)
+            iec_free(str->buffer.value);
+    }
+    if (IEC_T_EXTERNAL((*var)->type))
+        iec_free((*var)->value);
+    (*var)->v_raw = 0;
 }
 
 /**
@@ -1059,7 +1078,7 @@ static inline void iec_free_value(iec_t *var) {
  */
 static inline void iec_deinit(iec_t *var) {
     iec_free_value(var);
-    free(*var);
+    iec_free(*var);
 }
 
 /**
@@ -1070,26 +1089,114 @@ static inline void iec_deinit(iec_t *var) {
  * @param tpy
  */
 static inline void iec_totype(iec_t *data, uint8_t tpy) {
-    void *_tmp_ = NULL;
-    uint8_t tp_old = (*data)->type;
-
-    if (ANY_NUM(tp_old) || ANY_BOOL(tp_old)) {
-        iec_new_value(&_tmp_, tp_old);
-        iec_set_value_type(_tmp_, iec_get_value(*data), tp_old);
-    }
+    struct iec_t old = **data;
 
+    iec_free_value(data);
     (*data)->type = tpy;
     (*data)->any_type = IEC_ANYTYPE(tpy);
+    iec_new_value(&((*data)->value), tpy);
 
-    iec_free_value(data);
-    if (!ANY_STRING(tp_old)) {
-        iec_new_value(&((*data)->value), tpy);
+    if (ANY_REAL(old.type)) {
+        iec_set_real((*data), iec_get_real(&old));
+    } else if (ANY_NUM(old.type) || ANY_BOOL(old.type)) {
+        iec_set_int((*data), iec_get_int(&old));
+    }
+}
+
+/**
+ * @fn static inline uint8_t iec_string_reserve(string_t *str, uint32_t length)
+ * @brief make storage of string able to hold length characters, keeping content. Short strings use
+ *        inline storage; bounded strings (STRING[n]) allocate n once. Slices are detached only if storage moves
+ *
+ * @param str
+ * @param length
+ * @return status
+ */
+static inline uint8_t iec_string_reserve(string_t *str, uint32_t length) {
+    if (str->max > 0 && length > str->max)
+        length = str->max;
+    if (str->buffer.value != NULL && str->buffer.capacity > length)
+        return IEC_OK;
+
+    if (str->buffer.value == NULL && length <= IEC_STRING_SSO) {
+        str->buffer.value = str->local;
+        str->buffer.capacity = sizeof(str->local);
+        str->buffer.length = 0;
+        TERMINATE_STRING(&str->buffer);
+        return IEC_OK;
+    }
+
+    uint32_t capacity = (str->max > 0 ? str->max : length) + 1;
+    char *buffer = iec_malloc(capacity);
+    if (buffer == NULL)
+        return IEC_ERR;
+    iec_string_detach(str);
+    if (str->buffer.value != NULL) {
+        memcpy(buffer, str->buffer.value, str->buffer.length + 1);
+        if (str->buffer.value != str->local)
+            iec_free(str->buffer.value);
+    } else {
+        buffer[0] = '\0';
+        str->buffer.length = 0;
     }
+    str->buffer.value = buffer;
+    str->buffer.capacity = capacity;
 
-    if (ANY_NUM(tp_old) || ANY_BOOL(tp_old)) {
-        iec_set_value((*data), iec_get_value_type(_tmp_, tp_old));
-        free(_tmp_);
+    return IEC_OK;
+}
+
+/**
+ * @fn static inline uint8_t iec_string_copy(string_t *str, const char *chars, uint32_t length)
+ * @brief copy chars into owned storage of string. Storage is reused if it has enough capacity
+ *
+ * @param str
+ * @param chars
+ * @param length
+ * @return status (IEC_TRN if truncated to max length)
+ */
+static inline uint8_t iec_string_copy(string_t *str, const char *chars, uint32_t length) {
+    uint8_t status = IEC_OK;
+
+    if (str->max > 0 && length > str->max) {
+        length = str->max;
+        status = IEC_TRN;
     }
+    if (iec_string_reserve(str, length) != IEC_OK)
+        return IEC_ERR;
+
+    iec_string_detach(str);
+    if (length > 0)
+        memmove(str->buffer.value, chars, length);
+    str->buffer.length = length;
+    TERMINATE_STRING(&str->buffer);
+    str->str = &str->buffer;
+    str->len = length;
+    str->hash = 0;
+    str->interned = false;
+
+    return status;
+}
+
+/**
+ * @fn static inline bool iec_string_equal(const string_t *a, const string_t *b)
+ * @brief content equality. Shared (interned) storage is equal by pointer; when both hashes are known a
+ *        mismatch rejects without reading characters
+ *
+ * @param a
+ * @param b
+ * @return true if equal
+ */
+static inline bool iec_string_equal(const string_t *a, const string_t *b) {
+    if (a->str == b->str)
+        return true;
+
+    uint32_t length = a->str != NULL ? a->str->length : 0;
+    if (length != (b->str != NULL ? b->str->length : 0))
+        return false;
+    if (a->hash != 0 && b->hash != 0 && a->hash != b->hash)
+        return false;
+
+    return length == 0 || memcmp(a->str->value, b->str->value, length) == 0;
 }
 
 /**
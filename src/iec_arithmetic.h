@@ -32,10 +32,10 @@
 #define IEC_ARITHMETIC_H_
 
 #include <math.h>
-#include <stdio.h>
 
 #include "util_stack.h"
 #include "iec_selection.h"
+#include "iec_fastpath.h"
 
 /*
  * Summary:
@@ -49,6 +49,77 @@
  *  EXPT          ANY_NUM                 2           Raise to power
  */
 
+/**
+ * @def IEC_ARITH_REAL
+ * @brief true if arithmetic on data is done in floating point
+ *
+ */
+#define IEC_ARITH_REAL(data)  IEC_VALUE_REAL(data)
+
+/**
+ * @def IEC_ARITH
+ * @brief result = a OP b in class of result type: double for ANY_REAL and TIME, int64_t for signed, uint64_t for
+ *        others. Signed operation is done in uint64_t so overflow wraps. Not for division
+ *
+ */
+#define IEC_ARITH(result, a, OP, b)                                                                          \
+            if (IEC_ARITH_REAL(result))                                                                      \
+                iec_set_real((result), iec_get_real(a) OP iec_get_real(b));                                  \
+            else if ((result)->any_type & ANY_SIGNED_BIT)                                                    \
+                iec_set_int((result), (int64_t) ((uint64_t) iec_get_int(a) OP (uint64_t) iec_get_int(b)));   \
+            else                                                                                             \
+                iec_set_uint((result), iec_get_uint(a) OP iec_get_uint(b))
+
+/**
+ * @fn static inline void iec_arith_result(iec_t *result, iec_t v1, iec_t v2)
+ * @brief set result to the widest type of operands
+ *
+ * @param result
+ * @param v1
+ * @param v2
+ */
+static inline void iec_arith_result(iec_t *result, iec_t v1, iec_t v2) {
+    uint8_t type = v1->type > v2->type ? v1->type : v2->type;
+
+    if ((*result)->type != type)
+        iec_totype(result, type);
+}
+
+/**
+ * @fn uint8_t iec_add_n(iec_t *result, iec_t *args, size_t n)
+ * @brief Addition of n inputs. Result has the widest type of inputs
+ *
+ * @param result
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_add_n(iec_t *result, iec_t *args, size_t n) {
+    if (*result == NULL || args == NULL)
+        return IEC_NLL;
+    if (n == 0)
+        return IEC_ENL;
+
+    uint8_t type = IEC_T_NULL;
+    for (size_t i = 0; i < n; i++) {
+        iec_anytype_allowed(args[i], ANY_MAGNITUDE,,,,,);
+        if (args[i]->type > type)
+            type = args[i]->type;
+    }
+
+    iec_move(result, args[0]);
+    iec_type_promote(result, type);
+    for (size_t i = 1; i < n; i++) {
+        if (args[i]->type == type && IEC_FAST_ADD[type] != NULL)
+            IEC_FAST_ADD[type](result, *result, args[i]);
+        else {
+            IEC_ARITH(*result, *result, +, args[i]);
+        }
+    }
+
+    return IEC_OK;
+}
+
 /**
  * @fn uint8_t iec_add(iec_t *result, stack_t *list)
  * @brief
@@ -58,22 +129,47 @@
  * @return status
  */
 uint8_t iec_add(iec_t *result, stack_t *list) {
-    if (*result == NULL || list == NULL)
+    if (*result == NULL || list == NULL || *list == NULL)
         return IEC_NLL;
 
-    iec_t tmp = IEC_ALLOC;
-    iec_init(&tmp, IEC_T_NULL);
-    iec_move(result, (iec_t) stack_pop(*list));
-    iec_anytype_allowed(*result, ANY_MAGNITUDE,,,,,);
+    uint8_t res = iec_add_n(result, (iec_t*) stack_items(*list), stack_size(*list));
+    stack_flush(*list);
+
+    return res;
+}
 
-    while (!stack_empty(*list)) {
-        iec_move(&tmp, (iec_t) stack_pop(*list));
-        iec_anytype_allowed(tmp, ANY_MAGNITUDE,,,,,);
-        iec_type_promote(result, tmp->type);
-        iec_set_value(*result, (iec_get_value(*result)) + (iec_get_value(tmp)));
+/**
+ * @fn uint8_t iec_mul_n(iec_t *result, iec_t *args, size_t n)
+ * @brief Multiplication of n inputs. Result has the widest type of inputs
+ *
+ * @param result
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_mul_n(iec_t *result, iec_t *args, size_t n) {
+    if (*result == NULL || args == NULL)
+        return IEC_NLL;
+    if (n == 0)
+        return IEC_ENL;
+
+    uint8_t type = IEC_T_NULL;
+    for (size_t i = 0; i < n; i++) {
+        iec_anytype_allowed(args[i], ANY_MAGNITUDE,,,,,);
+        if (args[i]->type > type)
+            type = args[i]->type;
+    }
+
+    iec_move(result, args[0]);
+    iec_type_promote(result, type);
+    for (size_t i = 1; i < n; i++) {
+        if (args[i]->type == type && IEC_FAST_MUL[type] != NULL)
+            IEC_FAST_MUL[type](result, *result, args[i]);
+        else {
+            IEC_ARITH(*result, *result, *, args[i]);
+        }
     }
 
-    iec_deinit(&tmp);
     return IEC_OK;
 }
 
@@ -86,23 +182,13 @@ uint8_t iec_add(iec_t *result, stack_t *list) {
  * @return status
  */
 uint8_t iec_mul(iec_t *result, stack_t *list) {
-    if (*result == NULL || list == NULL)
+    if (*result == NULL || list == NULL || *list == NULL)
         return IEC_NLL;
 
-    iec_t tmp = IEC_ALLOC;
-    iec_init(&tmp, IEC_T_NULL);
-    iec_move(result, (iec_t) stack_pop(*list));
-    iec_anytype_allowed(*result, ANY_MAGNITUDE,,,,,);
+    uint8_t res = iec_mul_n(result, (iec_t*) stack_items(*list), stack_size(*list));
+    stack_flush(*list);
 
-    while (!stack_empty(*list)) {
-        iec_move(&tmp, (iec_t) stack_pop(*list));
-        iec_anytype_allowed(tmp, ANY_MAGNITUDE,,,,,);
-        iec_type_promote(result, tmp->type);
-        iec_set_value(*result, (iec_get_value(*result)) * (iec_get_value(tmp)));
-    }
-
-    iec_deinit(&tmp);
-    return IEC_OK;
+    return res;
 }
 
 /**
@@ -118,9 +204,11 @@ uint8_t iec_sub(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_MAGNITUDE,,,,,);
     iec_anytype_allowed(v2, ANY_MAGNITUDE,,,,,);
 
-    iec_type_promote(result, v1->type);
-    iec_type_promote(result, v2->type);
-    iec_set_value(*result, (iec_get_value(v1)) - (iec_get_value(v2)));
+    if (v1->type == v2->type && IEC_FAST_SUB[v1->type] != NULL)
+        return IEC_FAST_SUB[v1->type](result, v1, v2);
+
+    iec_arith_result(result, v1, v2);
+    IEC_ARITH(*result, v1, -, v2);
 
     return IEC_OK;
 }
@@ -137,18 +225,23 @@ uint8_t iec_sub(iec_t *result, iec_t v1, iec_t v2) {
 uint8_t iec_div(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_MAGNITUDE,ANY_NUM,,,,);
     iec_anytype_allowed(v2, ANY_MAGNITUDE,ANY_NUM,,,,);
-    if ((iec_get_value(v2)) == 0)
+
+    if (v1->type == v2->type && IEC_FAST_DIV[v1->type] != NULL)
+        return IEC_FAST_DIV[v1->type](result, v1, v2);
+
+    if ((iec_get_real(v2)) == 0)
         return IEC_NAT;
 
-    printf("type: %d\n", (*result)->type);
-    iec_type_promote(result, v1->type);
-    iec_type_promote(result, v2->type);
-    printf("-type: %d\n", (*result)->type);
-    float va, vb;
-    va=iec_get_value(v1);
-    vb=iec_get_value(v2);
-    printf("%f/%f: %f\n", va, vb, va/vb);
-    iec_set_value(*result, (iec_get_value(v1)) / (iec_get_value(v2)));
+    iec_arith_result(result, v1, v2);
+
+    if (IEC_ARITH_REAL(*result))
+        iec_set_real(*result, iec_get_real(v1) / iec_get_real(v2));
+    else if (!((*result)->any_type & ANY_SIGNED_BIT))
+        iec_set_uint(*result, iec_get_uint(v1) / iec_get_uint(v2));
+    else if (iec_get_int(v2) == -1)
+        iec_set_int(*result, (int64_t) (0 - (uint64_t) iec_get_int(v1)));
+    else
+        iec_set_int(*result, iec_get_int(v1) / iec_get_int(v2));
 
     return IEC_OK;
 }
@@ -166,12 +259,17 @@ uint8_t iec_mod(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_INT,,,,,);
     iec_anytype_allowed(v2, ANY_INT,,,,,);
 
-    if ((iec_get_value(v2)) == 0) {
-        iec_set_value(*result, 0);
-        return IEC_OK;
-    }
+    if (v1->type == v2->type && IEC_FAST_MOD[v1->type] != NULL)
+        return IEC_FAST_MOD[v1->type](result, v1, v2);
+
+    iec_arith_result(result, v1, v2);
 
-    iec_set_value(*result, (iec_get_value(v1) % iec_get_value(v2)));
+    if (iec_get_int(v2) == 0 || (((*result)->any_type & ANY_SIGNED_BIT) && iec_get_int(v2) == -1))
+        iec_set_int(*result, 0);
+    else if (!((*result)->any_type & ANY_SIGNED_BIT))
+        iec_set_uint(*result, iec_get_uint(v1) % iec_get_uint(v2));
+    else
+        iec_set_int(*result, iec_get_int(v1) % iec_get_int(v2));
 
     return IEC_OK;
 }
@@ -193,7 +291,7 @@ uint8_t iec_expt(iec_t *result, iec_t v1, iec_t v2) {
     iec_type_promote(&v1, IEC_T_LREAL);
     iec_type_promote(&v2, IEC_T_LREAL);
 
-    iec_set_value(*result, (iec_get_value(v1) ^ iec_get_value(v2)));
+    iec_set_real(*result, pow(iec_get_real(v1), iec_get_real(v2)));
 
     return IEC_OK;
 }
@@ -0,0 +1,669 @@
+/**
+ * @file iec_batch.h
+ * @brief Arithmetic over contiguous arrays of one type, with SIMD kernels selected at run time
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_BATCH_H_
+#define IEC_BATCH_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iec61131lib.h"
+#include "iec_batch_level.h"
+
+/*
+ * Summary:
+ *
+ *  Function      Parameter Type            Description
+ *  ADD_BATCH     INT, DINT, LINT, REAL, LREAL  dst[i] = a[i] + b[i]
+ *  SUB_BATCH     INT, DINT, LINT, REAL, LREAL  dst[i] = a[i] - b[i]
+ *  MUL_BATCH     INT, DINT, LINT, REAL, LREAL  dst[i] = a[i] * b[i]
+ *  DIV_BATCH     INT, DINT, LINT, REAL, LREAL  dst[i] = a[i] / b[i]
+ *  MOD_BATCH     INT, DINT, LINT               dst[i] = a[i] MOD b[i]
+ *  EXPT_BATCH    INT, DINT, LINT, REAL, LREAL  dst[i] = a[i] ** b[i]
+ *  GT_BATCH .. NE_BATCH                        bit i of mask = a[i] > b[i] (>=, =, <=, <, <>)
+ *
+ *  dst, a and b are C arrays of the type with n elements, dst may be a or b.
+ *  mask is packed BOOL: IEC_BATCH_MASK_WORDS(n) words, element i in bit i % 64 of word i / 64, unused bits are 0.
+ *  Integer results wrap as in iec_fastpath.h. Status is reported once per batch:
+ *    IEC_OOR  at least one integer division by zero (element result is 0) or floating division by zero
+ *    IEC_TRN  at least one integer result overflowed or was truncated (EXPT: clamped to range, fraction dropped)
+ *    IEC_NAT  type not supported by operation
+ *
+ *  SSE2 and AVX2 kernels are used on x86 when the CPU supports them (ADD/SUB on integers and INT MUL,
+ *  ADD/SUB/MUL/DIV on reals, comparisons on all types but LINT with SSE2), the rest and the tail of each batch
+ *  run in scalar code.
+ *  Define IEC_BATCH_SCALAR to build without SIMD.
+ */
+
+/**
+ * @name batch flags
+ * @brief internal, combined into status at end of batch
+ *
+ */
+/**@{*/
+#define IEC_BATCH_TRN  0x01
+#define IEC_BATCH_OOR  0x02
+/**@}*/
+
+/**
+ * @def IEC_BATCH_MASK_WORDS
+ * @brief words of packed BOOL mask for n elements
+ *
+ */
+#define IEC_BATCH_MASK_WORDS(n)  (((n) + 63) / 64)
+
+/**
+ * @fn static inline uint8_t iec_batch_status(uint8_t flags)
+ * @brief
+ *
+ * @param flags
+ * @return status
+ */
+static inline uint8_t iec_batch_status(uint8_t flags) {
+    if (flags & IEC_BATCH_OOR)
+        return IEC_OOR;
+    if (flags & IEC_BATCH_TRN)
+        return IEC_TRN;
+    return IEC_OK;
+}
+
+/**
+ * @name scalar kernels
+ * @brief process elements from .. n - 1, return flags
+ *
+ */
+/**@{*/
+#ifdef __GNUC__
+#define IEC_BATCH_MUL_OVF(ctype, utype, x, y, r)  __builtin_mul_overflow((x), (y), &(r))
+#else
+#define IEC_BATCH_MUL_OVF(ctype, utype, x, y, r)                                                  \
+            ((r) = (ctype) (1U * (utype) (x) * (utype) (y)),                                      \
+                ((x) == -1 && (y) == (ctype) ((utype) 1 << (8 * sizeof(ctype) - 1)))              \
+                || ((x) != 0 && (x) != -1 && (r) / (x) != (y)))
+#endif
+
+#define IEC_BATCH_SCALAR_INT(name, ctype, utype)                                                                    \
+static uint8_t iec_batch_add_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        ctype x = a[i], y = b[i], r = (ctype) ((utype) x + (utype) y);                                              \
+        if (((x ^ r) & (y ^ r)) < 0)                                                                                \
+            flags |= IEC_BATCH_TRN;                                                                                 \
+        dst[i] = r;                                                                                                 \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}                                                                                                                   \
+static uint8_t iec_batch_sub_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        ctype x = a[i], y = b[i], r = (ctype) ((utype) x - (utype) y);                                              \
+        if (((x ^ y) & (x ^ r)) < 0)                                                                                \
+            flags |= IEC_BATCH_TRN;                                                                                 \
+        dst[i] = r;                                                                                                 \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}                                                                                                                   \
+static uint8_t iec_batch_mul_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        ctype x = a[i], y = b[i], r;                                                                                \
+        if (IEC_BATCH_MUL_OVF(ctype, utype, x, y, r))                                                               \
+            flags |= IEC_BATCH_TRN;                                                                                 \
+        dst[i] = r;                                                                                                 \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}                                                                                                                   \
+static uint8_t iec_batch_div_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        ctype x = a[i], y = b[i];                                                                                   \
+        if (y == 0) {                                                                                               \
+            flags |= IEC_BATCH_OOR;                                                                                 \
+            dst[i] = 0;                                                                                             \
+        } else if (y == -1) {                                                                                       \
+            dst[i] = (ctype) (0U - (utype) x);                                                                      \
+            if (x < 0 && dst[i] < 0)                                                                                \
+                flags |= IEC_BATCH_TRN;                                                                             \
+        } else                                                                                                      \
+            dst[i] = x / y;                                                                                         \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}                                                                                                                   \
+static uint8_t iec_batch_mod_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        ctype x = a[i], y = b[i];                                                                                   \
+        if (y == 0)                                                                                                 \
+            flags |= IEC_BATCH_OOR;                                                                                 \
+        dst[i] = (y == 0 || y == -1) ? 0 : x % y;                                                                   \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}                                                                                                                   \
+static uint8_t iec_batch_expt_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    const double limit = ldexp(1, 8 * sizeof(ctype) - 1);                                                           \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        double p = pow(a[i], b[i]);                                                                                 \
+        if (isnan(p) || p >= limit || p < -limit) {                                                                 \
+            flags |= IEC_BATCH_TRN;                                                                                 \
+            dst[i] = (ctype) ((p < 0) ? (utype) 1 << (8 * sizeof(ctype) - 1) : ((utype) 1 << (8 * sizeof(ctype) - 1)) - 1); \
+            continue;                                                                                               \
+        }                                                                                                           \
+        if (p != trunc(p))                                                                                          \
+            flags |= IEC_BATCH_TRN;                                                                                 \
+        dst[i] = (ctype) p;                                                                                         \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}
+
+#define IEC_BATCH_SCALAR_REAL(name, ctype, powfn)                                                                   \
+static uint8_t iec_batch_add_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    for (size_t i = from; i < n; i++)                                                                               \
+        dst[i] = a[i] + b[i];                                                                                       \
+    return 0;                                                                                                       \
+}                                                                                                                   \
+static uint8_t iec_batch_sub_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    for (size_t i = from; i < n; i++)                                                                               \
+        dst[i] = a[i] - b[i];                                                                                       \
+    return 0;                                                                                                       \
+}                                                                                                                   \
+static uint8_t iec_batch_mul_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    for (size_t i = from; i < n; i++)                                                                               \
+        dst[i] = a[i] * b[i];                                                                                       \
+    return 0;                                                                                                       \
+}                                                                                                                   \
+static uint8_t iec_batch_div_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    uint8_t flags = 0;                                                                                              \
+    for (size_t i = from; i < n; i++) {                                                                             \
+        if (b[i] == 0)                                                                                              \
+            flags |= IEC_BATCH_OOR;                                                                                 \
+        dst[i] = a[i] / b[i];                                                                                       \
+    }                                                                                                               \
+    return flags;                                                                                                   \
+}                                                                                                                   \
+static uint8_t iec_batch_expt_ ## name ## _scalar(ctype *dst, const ctype *a, const ctype *b, size_t from, size_t n) { \
+    for (size_t i = from; i < n; i++)                                                                               \
+        dst[i] = powfn(a[i], b[i]);                                                                                 \
+    return 0;                                                                                                       \
+}
+
+#define IEC_BATCH_SCALAR_CMP(op, OP, name, ctype)                                                                   \
+static uint8_t iec_batch_ ## op ## _ ## name ## _scalar(uint64_t *mask, const ctype *a, const ctype *b, size_t from, \
+        size_t n) {                                                                                                 \
+    for (size_t i = from; i < n; i++)                                                                               \
+        mask[i >> 6] |= (uint64_t) (a[i] OP b[i]) << (i & 63);                                                      \
+    return 0;                                                                                                       \
+}
+#define IEC_BATCH_SCALAR_CMPS(name, ctype)                                                                          \
+    IEC_BATCH_SCALAR_CMP(gt, >, name, ctype)                                                                        \
+    IEC_BATCH_SCALAR_CMP(ge, >=, name, ctype)                                                                       \
+    IEC_BATCH_SCALAR_CMP(eq, ==, name, ctype)                                                                       \
+    IEC_BATCH_SCALAR_CMP(le, <=, name, ctype)                                                                       \
+    IEC_BATCH_SCALAR_CMP(lt, <, name, ctype)                                                                        \
+    IEC_BATCH_SCALAR_CMP(ne, !=, name, ctype)
+
+IEC_BATCH_SCALAR_INT(INT, int16_t, uint16_t)
+IEC_BATCH_SCALAR_INT(DINT, int32_t, uint32_t)
+IEC_BATCH_SCALAR_INT(LINT, int64_t, uint64_t)
+IEC_BATCH_SCALAR_REAL(REAL, float, powf)
+IEC_BATCH_SCALAR_REAL(LREAL, double, pow)
+IEC_BATCH_SCALAR_CMPS(INT, int16_t)
+IEC_BATCH_SCALAR_CMPS(DINT, int32_t)
+IEC_BATCH_SCALAR_CMPS(LINT, int64_t)
+IEC_BATCH_SCALAR_CMPS(REAL, float)
+IEC_BATCH_SCALAR_CMPS(LREAL, double)
+/**@}*/
+
+#ifdef IEC_BATCH_X86
+/**
+ * @name SIMD kernels
+ * @brief process whole vectors from element 0, store number of processed elements in done and return flags.
+ *        Generated for each ISA: pfx is intrinsic prefix, si integer vector suffix
+ *
+ */
+/**@{*/
+#define IEC_BATCH_TARGET_sse2  __attribute__((target("sse2")))
+#define IEC_BATCH_TARGET_avx2  __attribute__((target("avx2")))
+
+#define IEC_BATCH_CMPEQ_sse2(sfx, a, b)  _mm_cmpeq_ ## sfx(a, b)
+#define IEC_BATCH_CMPEQ_avx2(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_EQ_OQ)
+
+/* bytes of movemask_epi8 holding sign of lanes */
+#define IEC_BATCH_SIGN_16  0xAAAAAAAAU
+#define IEC_BATCH_SIGN_32  0x88888888U
+#define IEC_BATCH_SIGN_64  0x80808080U
+
+#define IEC_BATCH_OVF_add(pfx, si, a, b, r)  pfx ## _and_ ## si(pfx ## _xor_ ## si(a, r), pfx ## _xor_ ## si(b, r))
+#define IEC_BATCH_OVF_sub(pfx, si, a, b, r)  pfx ## _and_ ## si(pfx ## _xor_ ## si(a, b), pfx ## _xor_ ## si(a, r))
+
+#define IEC_BATCH_VEC_INT(isa, pfx, si, vec, op, name, ctype, bits)                                                 \
+static IEC_BATCH_TARGET_ ## isa uint8_t iec_batch_ ## op ## _ ## name ## _ ## isa(ctype *dst, const ctype *a,       \
+        const ctype *b, size_t n, size_t *done) {                                                                   \
+    const size_t lanes = sizeof(vec) / sizeof(ctype);                                                               \
+    vec ovf = pfx ## _setzero_ ## si();                                                                             \
+    size_t i = 0;                                                                                                   \
+    for (; i + lanes <= n; i += lanes) {                                                                            \
+        vec va = pfx ## _loadu_ ## si((const vec*) (a + i));                                                        \
+        vec vb = pfx ## _loadu_ ## si((const vec*) (b + i));                                                        \
+        vec r = pfx ## _ ## op ## _epi ## bits(va, vb);                                                             \
+        ovf = pfx ## _or_ ## si(ovf, IEC_BATCH_OVF_ ## op(pfx, si, va, vb, r));                                     \
+        pfx ## _storeu_ ## si((vec*) (dst + i), r);                                                                 \
+    }                                                                                                               \
+    (*done) = i;                                                                                                    \
+    return ((unsigned) pfx ## _movemask_epi8(ovf) & IEC_BATCH_SIGN_ ## bits) ? IEC_BATCH_TRN : 0;                   \
+}
+
+#define IEC_BATCH_VEC_MUL16(isa, pfx, si, vec)                                                                      \
+static IEC_BATCH_TARGET_ ## isa uint8_t iec_batch_mul_INT_ ## isa(int16_t *dst, const int16_t *a, const int16_t *b, \
+        size_t n, size_t *done) {                                                                                   \
+    const size_t lanes = sizeof(vec) / sizeof(int16_t);                                                             \
+    vec ovf = pfx ## _setzero_ ## si();                                                                             \
+    size_t i = 0;                                                                                                   \
+    for (; i + lanes <= n; i += lanes) {                                                                            \
+        vec va = pfx ## _loadu_ ## si((const vec*) (a + i));                                                        \
+        vec vb = pfx ## _loadu_ ## si((const vec*) (b + i));                                                        \
+        vec lo = pfx ## _mullo_epi16(va, vb);                                                                       \
+        vec hi = pfx ## _mulhi_epi16(va, vb);                                                                       \
+        ovf = pfx ## _or_ ## si(ovf, pfx ## _xor_ ## si(hi, pfx ## _srai_epi16(lo, 15)));                           \
+        pfx ## _storeu_ ## si((vec*) (dst + i), lo);                                                                \
+    }                                                                                                               \
+    (*done) = i;                                                                                                    \
+    unsigned zero = (unsigned) pfx ## _movemask_epi8(pfx ## _cmpeq_epi8(ovf, pfx ## _setzero_ ## si()));            \
+    return zero != (unsigned) ((1ULL << sizeof(vec)) - 1) ? IEC_BATCH_TRN : 0;                                      \
+}
+
+#define IEC_BATCH_VEC_REAL(isa, pfx, sfx, vec, op, name, ctype)                                                     \
+static IEC_BATCH_TARGET_ ## isa uint8_t iec_batch_ ## op ## _ ## name ## _ ## isa(ctype *dst, const ctype *a,       \
+        const ctype *b, size_t n, size_t *done) {                                                                   \
+    const size_t lanes = sizeof(vec) / sizeof(ctype);                                                               \
+    vec zero = pfx ## _setzero_ ## sfx();                                                                           \
+    int divzero = 0;                                                                                                \
+    size_t i = 0;                                                                                                   \
+    for (; i + lanes <= n; i += lanes) {                                                                            \
+        vec va = pfx ## _loadu_ ## sfx(a + i);                                                                      \
+        vec vb = pfx ## _loadu_ ## sfx(b + i);                                                                      \
+        if (IEC_BATCH_IS_ ## op)                                                                                    \
+            divzero |= pfx ## _movemask_ ## sfx(IEC_BATCH_CMPEQ_ ## isa(sfx, vb, zero));                            \
+        pfx ## _storeu_ ## sfx(dst + i, pfx ## _ ## op ## _ ## sfx(va, vb));                                        \
+    }                                                                                                               \
+    (*done) = i;                                                                                                    \
+    return divzero ? IEC_BATCH_OOR : 0;                                                                             \
+}
+#define IEC_BATCH_IS_add 0
+#define IEC_BATCH_IS_sub 0
+#define IEC_BATCH_IS_mul 0
+#define IEC_BATCH_IS_div 1
+
+#define IEC_BATCH_VEC_ISA(isa, pfx, si, veci, vecf, vecd)                                                           \
+    IEC_BATCH_VEC_INT(isa, pfx, si, veci, add, INT, int16_t, 16)                                                    \
+    IEC_BATCH_VEC_INT(isa, pfx, si, veci, sub, INT, int16_t, 16)                                                    \
+    IEC_BATCH_VEC_INT(isa, pfx, si, veci, add, DINT, int32_t, 32)                                                   \
+    IEC_BATCH_VEC_INT(isa, pfx, si, veci, sub, DINT, int32_t, 32)                                                   \
+    IEC_BATCH_VEC_INT(isa, pfx, si, veci, add, LINT, int64_t, 64)                                                   \
+    IEC_BATCH_VEC_INT(isa, pfx, si, veci, sub, LINT, int64_t, 64)                                                   \
+    IEC_BATCH_VEC_MUL16(isa, pfx, si, veci)                                                                         \
+    IEC_BATCH_VEC_REAL(isa, pfx, ps, vecf, add, REAL, float)                                                        \
+    IEC_BATCH_VEC_REAL(isa, pfx, ps, vecf, sub, REAL, float)                                                        \
+    IEC_BATCH_VEC_REAL(isa, pfx, ps, vecf, mul, REAL, float)                                                        \
+    IEC_BATCH_VEC_REAL(isa, pfx, ps, vecf, div, REAL, float)                                                        \
+    IEC_BATCH_VEC_REAL(isa, pfx, pd, vecd, add, LREAL, double)                                                      \
+    IEC_BATCH_VEC_REAL(isa, pfx, pd, vecd, sub, LREAL, double)                                                      \
+    IEC_BATCH_VEC_REAL(isa, pfx, pd, vecd, mul, LREAL, double)                                                      \
+    IEC_BATCH_VEC_REAL(isa, pfx, pd, vecd, div, LREAL, double)
+
+IEC_BATCH_VEC_ISA(sse2, _mm, si128, __m128i, __m128, __m128d)
+IEC_BATCH_VEC_ISA(avx2, _mm256, si256, __m256i, __m256, __m256d)
+
+/* integer compare: gt/eq instruction, swapped operands, inverted result */
+#define IEC_BATCH_ICMP_gt(pfx, bits, a, b)  pfx ## _cmpgt_epi ## bits(a, b)
+#define IEC_BATCH_ICMP_lt(pfx, bits, a, b)  pfx ## _cmpgt_epi ## bits(b, a)
+#define IEC_BATCH_ICMP_ge(pfx, bits, a, b)  pfx ## _cmpgt_epi ## bits(b, a)
+#define IEC_BATCH_ICMP_le(pfx, bits, a, b)  pfx ## _cmpgt_epi ## bits(a, b)
+#define IEC_BATCH_ICMP_eq(pfx, bits, a, b)  pfx ## _cmpeq_epi ## bits(a, b)
+#define IEC_BATCH_ICMP_ne(pfx, bits, a, b)  pfx ## _cmpeq_epi ## bits(a, b)
+#define IEC_BATCH_INV_gt 0
+#define IEC_BATCH_INV_lt 0
+#define IEC_BATCH_INV_ge 1
+#define IEC_BATCH_INV_le 1
+#define IEC_BATCH_INV_eq 0
+#define IEC_BATCH_INV_ne 1
+
+/* one bit per lane from compare result */
+#define IEC_BATCH_LANES_16_sse2(c)  ((unsigned) _mm_movemask_epi8(_mm_packs_epi16(c, _mm_setzero_si128())))
+#define IEC_BATCH_LANES_16_avx2(c)                                                                \
+            ((unsigned) _mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(c), _mm256_extracti128_si256(c, 1))))
+#define IEC_BATCH_LANES_32_sse2(c)  ((unsigned) _mm_movemask_ps(_mm_castsi128_ps(c)))
+#define IEC_BATCH_LANES_32_avx2(c)  ((unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(c)))
+#define IEC_BATCH_LANES_64_sse2(c)  ((unsigned) _mm_movemask_pd(_mm_castsi128_pd(c)))
+#define IEC_BATCH_LANES_64_avx2(c)  ((unsigned) _mm256_movemask_pd(_mm256_castsi256_pd(c)))
+
+/* floating compare, false if unordered except ne (as C operators) */
+#define IEC_BATCH_FCMP_sse2_gt(sfx, a, b)  _mm_cmpgt_ ## sfx(a, b)
+#define IEC_BATCH_FCMP_sse2_ge(sfx, a, b)  _mm_cmpge_ ## sfx(a, b)
+#define IEC_BATCH_FCMP_sse2_eq(sfx, a, b)  _mm_cmpeq_ ## sfx(a, b)
+#define IEC_BATCH_FCMP_sse2_le(sfx, a, b)  _mm_cmple_ ## sfx(a, b)
+#define IEC_BATCH_FCMP_sse2_lt(sfx, a, b)  _mm_cmplt_ ## sfx(a, b)
+#define IEC_BATCH_FCMP_sse2_ne(sfx, a, b)  _mm_cmpneq_ ## sfx(a, b)
+#define IEC_BATCH_FCMP_avx2_gt(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_GT_OQ)
+#define IEC_BATCH_FCMP_avx2_ge(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_GE_OQ)
+#define IEC_BATCH_FCMP_avx2_eq(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_EQ_OQ)
+#define IEC_BATCH_FCMP_avx2_le(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_LE_OQ)
+#define IEC_BATCH_FCMP_avx2_lt(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_LT_OQ)
+#define IEC_BATCH_FCMP_avx2_ne(sfx, a, b)  _mm256_cmp_ ## sfx(a, b, _CMP_NEQ_UQ)
+
+#define IEC_BATCH_VEC_CMP_INT(isa, pfx, si, vec, op, name, ctype, bits)                                             \
+static IEC_BATCH_TARGET_ ## isa uint8_t iec_batch_ ## op ## _ ## name ## _ ## isa(uint64_t *mask, const ctype *a,   \
+        const ctype *b, size_t n, size_t *done) {                                                                   \
+    const size_t lanes = sizeof(vec) / sizeof(ctype);                                                               \
+    const unsigned all = (unsigned) ((1ULL << lanes) - 1);                                                          \
+    size_t i = 0;                                                                                                   \
+    for (; i + lanes <= n; i += lanes) {                                                                            \
+        vec va = pfx ## _loadu_ ## si((const vec*) (a + i));                                                        \
+        vec vb = pfx ## _loadu_ ## si((const vec*) (b + i));                                                        \
+        unsigned bits_set = IEC_BATCH_LANES_ ## bits ## _ ## isa(IEC_BATCH_ICMP_ ## op(pfx, bits, va, vb));         \
+        if (IEC_BATCH_INV_ ## op)                                                                                   \
+            bits_set = ~bits_set & all;                                                                             \
+        mask[i >> 6] |= (uint64_t) bits_set << (i & 63);                                                            \
+    }                                                                                                               \
+    (*done) = i;                                                                                                    \
+    return 0;                                                                                                       \
+}
+
+#define IEC_BATCH_VEC_CMP_REAL(isa, pfx, sfx, vec, op, name, ctype)                                                 \
+static IEC_BATCH_TARGET_ ## isa uint8_t iec_batch_ ## op ## _ ## name ## _ ## isa(uint64_t *mask, const ctype *a,   \
+        const ctype *b, size_t n, size_t *done) {                                                                   \
+    const size_t lanes = sizeof(vec) / sizeof(ctype);                                                               \
+    size_t i = 0;                                                                                                   \
+    for (; i + lanes <= n; i += lanes) {                                                                            \
+        vec c = IEC_BATCH_FCMP_ ## isa ## _ ## op(sfx, pfx ## _loadu_ ## sfx(a + i), pfx ## _loadu_ ## sfx(b + i)); \
+        mask[i >> 6] |= (uint64_t) pfx ## _movemask_ ## sfx(c) << (i & 63);                                         \
+    }                                                                                                               \
+    (*done) = i;                                                                                                    \
+    return 0;                                                                                                       \
+}
+
+#define IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, op)                                                       \
+    IEC_BATCH_VEC_CMP_INT(isa, pfx, si, veci, op, INT, int16_t, 16)                                                 \
+    IEC_BATCH_VEC_CMP_INT(isa, pfx, si, veci, op, DINT, int32_t, 32)                                                \
+    IEC_BATCH_VEC_CMP_REAL(isa, pfx, ps, vecf, op, REAL, float)                                                     \
+    IEC_BATCH_VEC_CMP_REAL(isa, pfx, pd, vecd, op, LREAL, double)
+#define IEC_BATCH_VEC_CMPS(isa, pfx, si, veci, vecf, vecd)                                                          \
+    IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, gt)                                                           \
+    IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, ge)                                                           \
+    IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, eq)                                                           \
+    IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, le)                                                           \
+    IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, lt)                                                           \
+    IEC_BATCH_VEC_CMP(isa, pfx, si, veci, vecf, vecd, ne)
+
+IEC_BATCH_VEC_CMPS(sse2, _mm, si128, __m128i, __m128, __m128d)
+IEC_BATCH_VEC_CMPS(avx2, _mm256, si256, __m256i, __m256, __m256d)
+IEC_BATCH_VEC_CMP_INT(avx2, _mm256, si256, __m256i, gt, LINT, int64_t, 64)
+IEC_BATCH_VEC_CMP_INT(avx2, _mm256, si256, __m256i, ge, LINT, int64_t, 64)
+IEC_BATCH_VEC_CMP_INT(avx2, _mm256, si256, __m256i, eq, LINT, int64_t, 64)
+IEC_BATCH_VEC_CMP_INT(avx2, _mm256, si256, __m256i, le, LINT, int64_t, 64)
+IEC_BATCH_VEC_CMP_INT(avx2, _mm256, si256, __m256i, lt, LINT, int64_t, 64)
+IEC_BATCH_VEC_CMP_INT(avx2, _mm256, si256, __m256i, ne, LINT, int64_t, 64)
+/**@}*/
+
+#define IEC_BATCH_RUN_SIMD(op, name, out)                                                                           \
+            switch (iec_batch_level()) {                                                                            \
+                case IEC_BATCH_AVX2:                                                                                \
+                    flags |= iec_batch_ ## op ## _ ## name ## _avx2((out) dst, a, b, n, &done);                     \
+                    break;                                                                                          \
+                case IEC_BATCH_SSE2:                                                                                \
+                    flags |= iec_batch_ ## op ## _ ## name ## _sse2((out) dst, a, b, n, &done);                     \
+                    break;                                                                                          \
+                default:                                                                                            \
+                    break;                                                                                          \
+            }
+#define IEC_BATCH_RUN_AVX2(op, name, out)                                                                           \
+            if (iec_batch_level() == IEC_BATCH_AVX2)                                                                \
+                flags |= iec_batch_ ## op ## _ ## name ## _avx2((out) dst, a, b, n, &done);
+#else
+#define IEC_BATCH_RUN_SIMD(op, name, out)
+#define IEC_BATCH_RUN_AVX2(op, name, out)
+#endif
+
+/**
+ * @name batch dispatch
+ * @brief SIMD kernel (if any) for whole vectors, scalar kernel for the rest. OUT gives output pointer type for
+ *        element C type
+ *
+ */
+/**@{*/
+#define IEC_BATCH_OUT_VALUE(ctype)  ctype*
+#define IEC_BATCH_OUT_MASK(ctype)   uint64_t*
+
+#define IEC_BATCH_RUN(op, name, ctype, OUT)                                                                         \
+            case IEC_T_ ## name:                                                                                    \
+                flags |= iec_batch_ ## op ## _ ## name ## _scalar((OUT(ctype)) dst, a, b, done, n);                 \
+                break;
+#define IEC_BATCH_RUN_VEC(op, name, ctype, OUT)                                                                     \
+            case IEC_T_ ## name:                                                                                    \
+                IEC_BATCH_RUN_SIMD(op, name, OUT(ctype))                                                            \
+                flags |= iec_batch_ ## op ## _ ## name ## _scalar((OUT(ctype)) dst, a, b, done, n);                 \
+                break;
+#define IEC_BATCH_RUN_VEC_AVX2(op, name, ctype, OUT)                                                                \
+            case IEC_T_ ## name:                                                                                    \
+                IEC_BATCH_RUN_AVX2(op, name, OUT(ctype))                                                            \
+                flags |= iec_batch_ ## op ## _ ## name ## _scalar((OUT(ctype)) dst, a, b, done, n);                 \
+                break;
+#define IEC_BATCH_NOT(op, name, ctype, OUT)
+
+#define IEC_BATCH_BODY(op, OUT, INT_, DINT_, LINT_, REAL_, LREAL_)                                                  \
+    uint8_t flags = 0;                                                                                              \
+    size_t done = 0;                                                                                                \
+    if (dst == NULL || a == NULL || b == NULL)                                                                      \
+        return IEC_NLL;                                                                                             \
+    switch (type) {                                                                                                 \
+        INT_(op, INT, int16_t, OUT)                                                                                 \
+        DINT_(op, DINT, int32_t, OUT)                                                                               \
+        LINT_(op, LINT, int64_t, OUT)                                                                               \
+        REAL_(op, REAL, float, OUT)                                                                                 \
+        LREAL_(op, LREAL, double, OUT)                                                                              \
+        default:                                                                                                    \
+            return IEC_NAT;                                                                                         \
+    }                                                                                                               \
+    return iec_batch_status(flags);
+
+#define IEC_BATCH_FN(op, INT_, DINT_, LINT_, REAL_, LREAL_)                                                         \
+uint8_t iec_ ## op ## _batch(void *dst, const void *a, const void *b, size_t n, iectype_t type) {                   \
+    IEC_BATCH_BODY(op, IEC_BATCH_OUT_VALUE, INT_, DINT_, LINT_, REAL_, LREAL_)                                      \
+}
+
+#define IEC_BATCH_CMP_FN(op)                                                                                        \
+uint8_t iec_ ## op ## _batch(uint64_t *dst, const void *a, const void *b, size_t n, iectype_t type) {               \
+    if (dst != NULL)                                                                                                \
+        memset(dst, 0, IEC_BATCH_MASK_WORDS(n) * sizeof(uint64_t));                                                 \
+    IEC_BATCH_BODY(op, IEC_BATCH_OUT_MASK, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC_AVX2,            \
+            IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC)                                                                   \
+}
+
+/**@}*/
+
+/**
+ * @fn uint8_t iec_add_batch(void *dst, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief dst[i] = a[i] + b[i]
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_FN(add, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC)
+
+/**
+ * @fn uint8_t iec_sub_batch(void *dst, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief dst[i] = a[i] - b[i]
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_FN(sub, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC)
+
+/**
+ * @fn uint8_t iec_mul_batch(void *dst, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief dst[i] = a[i] * b[i]
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_FN(mul, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC)
+
+/**
+ * @fn uint8_t iec_div_batch(void *dst, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief dst[i] = a[i] / b[i]
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_FN(div, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN_VEC, IEC_BATCH_RUN_VEC)
+
+/**
+ * @fn uint8_t iec_mod_batch(void *dst, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief dst[i] = a[i] MOD b[i]
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_FN(mod, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_NOT, IEC_BATCH_NOT)
+
+/**
+ * @fn uint8_t iec_expt_batch(void *dst, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief dst[i] = a[i] ** b[i]
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_FN(expt, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN, IEC_BATCH_RUN)
+
+/**
+ * @fn uint8_t iec_gt_batch(uint64_t *mask, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief bit i of mask = a[i] > b[i]
+ *
+ * @param mask
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_CMP_FN(gt)
+
+/**
+ * @fn uint8_t iec_ge_batch(uint64_t *mask, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief bit i of mask = a[i] >= b[i]
+ *
+ * @param mask
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_CMP_FN(ge)
+
+/**
+ * @fn uint8_t iec_eq_batch(uint64_t *mask, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief bit i of mask = a[i] = b[i]
+ *
+ * @param mask
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_CMP_FN(eq)
+
+/**
+ * @fn uint8_t iec_le_batch(uint64_t *mask, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief bit i of mask = a[i] <= b[i]
+ *
+ * @param mask
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_CMP_FN(le)
+
+/**
+ * @fn uint8_t iec_lt_batch(uint64_t *mask, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief bit i of mask = a[i] < b[i]
+ *
+ * @param mask
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_CMP_FN(lt)
+
+/**
+ * @fn uint8_t iec_ne_batch(uint64_t *mask, const void *a, const void *b, size_t n, iectype_t type)
+ * @brief bit i of mask = a[i] <> b[i]
+ *
+ * @param mask
+ * @param a
+ * @param b
+ * @param n
+ * @param type
+ * @return status
+ */
+IEC_BATCH_CMP_FN(ne)
+
+#endif /* IEC_BATCH_H_ */
@@ -0,0 +1,83 @@
+/**
+ * @file iec_batch_level.h
+ * @brief SIMD level of batch kernels (x86 SSE2 / AVX2), detected at run time
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_BATCH_LEVEL_H_
+#define IEC_BATCH_LEVEL_H_
+
+/*
+ * Shared by every module with SIMD kernels (iec_batch.h, util_search.h ...), so a single iec_batch_max_level
+ * selects the kernels of all of them. Define IEC_BATCH_SCALAR to build without SIMD.
+ */
+
+/**
+ * @name batch SIMD level
+ * @brief
+ *
+ */
+/**@{*/
+#define IEC_BATCH_NONE 0
+#define IEC_BATCH_SSE2 1
+#define IEC_BATCH_AVX2 2
+/**@}*/
+
+#if !defined(IEC_BATCH_SCALAR) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IEC_BATCH_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @var iec_batch_max_level
+ * @brief highest SIMD level allowed. Lower it to force scalar or SSE2 kernels
+ *
+ */
+static int iec_batch_max_level = IEC_BATCH_AVX2;
+
+/**
+ * @fn static inline int iec_batch_level(void)
+ * @brief SIMD level in use: supported by CPU (detected once) and not above iec_batch_max_level
+ *
+ * @return level
+ */
+static inline int iec_batch_level(void) {
+#ifdef IEC_BATCH_X86
+    static int cpu_level = -1;
+
+    if (cpu_level < 0) {
+        __builtin_cpu_init();
+        cpu_level = __builtin_cpu_supports("avx2") ? IEC_BATCH_AVX2 : __builtin_cpu_supports("sse2") ? IEC_BATCH_SSE2 : IEC_BATCH_NONE;
+    }
+
+    return cpu_level < iec_batch_max_level ? cpu_level : iec_batch_max_level;
+#else
+    return IEC_BATCH_NONE;
+#endif
+}
+
+#endif /* IEC_BATCH_LEVEL_H_ */
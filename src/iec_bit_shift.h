@@ -56,6 +56,20 @@
 #define rotr32(v, n) rotl32(v, 32 - (n))
 #define rotr64(v, n) rotl64(v, 64 - (n))
 
+/**
+ * @fn static inline int64_t iec_shift_count(iec_t v2)
+ * @brief shift count read in the class of v2 (REAL truncated)
+ *
+ * @param v2
+ * @return count
+ */
+static inline int64_t iec_shift_count(iec_t v2) {
+    if (IEC_VALUE_REAL(v2))
+        return (int64_t) iec_get_real(v2);
+
+    return (v2->any_type & ANY_SIGNED_BIT) ? iec_get_int(v2) : (int64_t) iec_get_uint(v2);
+}
+
 /**
  * @fn uint8_t iec_shl(iec_t *result, iec_t v1, iec_t v2)
  * @brief
@@ -70,10 +84,11 @@ uint8_t iec_shl(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v2, ANY_NUM,,,,,);
     iec_type_promote(result, v1->type);
 
-    maxuint_t _v1 = iec_get_value(v1);
-    maxuint_t _v2 = iec_get_value(v2);
+    maxuint_t _v1 = iec_get_uint(v1);
+    int64_t count = iec_shift_count(v2);
+    maxuint_t _v2 = count;
 
-    if (sign(iec_get_value(v2))) {
+    if (sign(count)) {
         _v1 = _v1 << _v2;
     } else {
         _v1 = _v1 >> _v2;
@@ -98,9 +113,10 @@ uint8_t iec_shr(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v2, ANY_NUM,,,,,);
     iec_type_promote(result, v1->type);
 
-    maxuint_t _v1 = iec_get_value(v1);
-    maxuint_t _v2 = iec_get_value(v2);
-    if (sign(iec_get_value(v2))) {
+    maxuint_t _v1 = iec_get_uint(v1);
+    int64_t count = iec_shift_count(v2);
+    maxuint_t _v2 = count;
+    if (sign(count)) {
         _v1 = _v1 >> _v2;
     } else {
         _v1 = _v1 << _v2;
@@ -124,9 +140,10 @@ uint8_t iec_rol(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v2, ANY_NUM,,,,,);
     iec_type_promote(result, v1->type);
 
-    maxuint_t _v1 = iec_get_value(v1);
-    maxuint_t _v2 = iec_get_value(v2);
-    if (sign(iec_get_value(v2))) {
+    maxuint_t _v1 = iec_get_uint(v1);
+    int64_t count = iec_shift_count(v2);
+    maxuint_t _v2 = count;
+    if (sign(count)) {
         switch (IEC_T_SIZEOF[v1->type]) {
             case 8:
                 _v1 = rotl8(_v1, _v2);
@@ -180,9 +197,10 @@ uint8_t iec_ror(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v2, ANY_NUM,,,,,);
     iec_type_promote(result, v1->type);
 
-    maxuint_t _v1 = iec_get_value(v1);
-    maxuint_t _v2 = iec_get_value(v2);
-    if (sign(iec_get_value(v2))) {
+    maxuint_t _v1 = iec_get_uint(v1);
+    int64_t count = iec_shift_count(v2);
+    maxuint_t _v2 = count;
+    if (sign(count)) {
         switch (IEC_T_SIZEOF[v1->type]) {
             case 8:
                 _v1 = rotr8(_v1, _v2);
@@ -31,6 +31,8 @@
 #ifndef IEC_BITWISE_BOOLEAN_H_
 #define IEC_BITWISE_BOOLEAN_H_
 
+#include "iec_fastpath.h"
+
 /*
  * Summary:
  *
@@ -39,7 +41,18 @@
  *  OR            ANY_BIT, ANY_INT        2            Logical OR
  *  XOR           ANY_BIT, ANY_INT        2            Logical XOR
  *  NOT           ANY_BIT, ANY_INT        1            Logical NOT
+ *
+ *  Result has the widest type of operands. On BOOL the operation is logical, on the others bitwise.
+ */
+
+/**
+ * @def IEC_BITWISE
+ * @brief result = v1 OP v2 in widest type of operands
+ *
  */
+#define IEC_BITWISE(result, v1, OP, v2)                                                           \
+            iec_fast_result(result, (v1)->type > (v2)->type ? (v1)->type : (v2)->type);           \
+            iec_set_uint(*(result), iec_get_uint(v1) OP iec_get_uint(v2))
 
 /**
  * @fn uint8_t iec_and(iec_t *result, iec_t v1, iec_t v2)
@@ -54,6 +67,8 @@ uint8_t iec_and(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_BIT, ANY_INT,,,,);
     iec_anytype_allowed(v2, ANY_BIT, ANY_INT,,,,);
 
+    IEC_BITWISE(result, v1, &, v2);
+
     return IEC_OK;
 }
 
@@ -70,6 +85,8 @@ uint8_t iec_or(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_BIT, ANY_INT,,,,);
     iec_anytype_allowed(v2, ANY_BIT, ANY_INT,,,,);
 
+    IEC_BITWISE(result, v1, |, v2);
+
     return IEC_OK;
 }
 
@@ -86,6 +103,8 @@ uint8_t iec_xor(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_BIT, ANY_INT,,,,);
     iec_anytype_allowed(v2, ANY_BIT, ANY_INT,,,,);
 
+    IEC_BITWISE(result, v1, ^, v2);
+
     return IEC_OK;
 }
 
@@ -100,6 +119,12 @@ uint8_t iec_xor(iec_t *result, iec_t v1, iec_t v2) {
 uint8_t iec_not(iec_t *result, iec_t v1) {
     iec_anytype_allowed(v1, ANY_BIT, ANY_INT,,,,);
 
+    iec_fast_result(result, v1->type);
+    if (ANY_BOOL(v1->type))
+        (*result)->v_bool = !v1->v_bool;
+    else
+        iec_set_uint(*result, ~iec_get_uint(v1));
+
     return IEC_OK;
 }
 
@@ -0,0 +1,432 @@
+/**
+ * @file iec_bool_bank.h
+ * @brief Packed BOOL storage (64 per word) with word at a time boolean logic
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_BOOL_BANK_H_
+#define IEC_BOOL_BANK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iec61131lib.h"
+#include "iec_batch.h"
+
+/*
+ * Summary:
+ *
+ *  Function      Parameter Type          Description
+ *  AND           packed BOOL             dst = a AND b
+ *  OR            packed BOOL             dst = a OR b
+ *  XOR           packed BOOL             dst = a XOR b
+ *  NOT           packed BOOL             dst = NOT a
+ *
+ *  A bank holds count BOOL, bit i % 64 of word i / 64: the same layout of masks from batch comparisons
+ *  (iec_gt_batch ...), so word functions work on both. Bits behind count are always 0.
+ *  Word functions use SSE2/AVX2 (128/256 contacts per instruction) as selected by iec_batch_level().
+ */
+
+/**
+ * @typedef iec_bool_bank_t
+ * @brief packed BOOL
+ *
+ */
+typedef struct iec_bool_bank_t {
+    uint64_t *words; /**< bits */
+    uint32_t count;  /**< number of BOOL */
+} iec_bool_bank_t;
+
+/**
+ * @name word kernels
+ * @brief dst[i] = a[i] OP b[i] (dst[i] = ~a[i] for NOT) for words 0 .. words - 1
+ *
+ */
+/**@{*/
+#define IEC_BOOL_SCALAR(op, OP)                                                                   \
+static void iec_bool_ ## op ## _scalar(uint64_t *dst, const uint64_t *a, const uint64_t *b,       \
+        size_t from, size_t words) {                                                              \
+    for (size_t i = from; i < words; i++)                                                         \
+        dst[i] = a[i] OP b[i];                                                                    \
+}
+
+IEC_BOOL_SCALAR(and, &)
+IEC_BOOL_SCALAR(or, |)
+IEC_BOOL_SCALAR(xor, ^)
+
+static void iec_bool_not_scalar(uint64_t *dst, const uint64_t *a, size_t from, size_t words) {
+    for (size_t i = from; i < words; i++)
+        dst[i] = ~a[i];
+}
+
+#ifdef IEC_BATCH_X86
+#define IEC_BOOL_VEC(isa, pfx, si, vec, op)                                                       \
+static IEC_BATCH_TARGET_ ## isa size_t iec_bool_ ## op ## _ ## isa(uint64_t *dst, const uint64_t *a, \
+        const uint64_t *b, size_t words) {                                                        \
+    const size_t lanes = sizeof(vec) / sizeof(uint64_t);                                          \
+    size_t i = 0;                                                                                 \
+    for (; i + lanes <= words; i += lanes) {                                                      \
+        vec va = pfx ## _loadu_ ## si((const vec*) (a + i));                                      \
+        vec vb = pfx ## _loadu_ ## si((const vec*) (b + i));                                      \
+        pfx ## _storeu_ ## si((vec*) (dst + i), pfx ## _ ## op ## _ ## si(va, vb));               \
+    }                                                                                             \
+    return i;                                                                                     \
+}
+
+IEC_BOOL_VEC(sse2, _mm, si128, __m128i, and)
+IEC_BOOL_VEC(sse2, _mm, si128, __m128i, or)
+IEC_BOOL_VEC(sse2, _mm, si128, __m128i, xor)
+IEC_BOOL_VEC(avx2, _mm256, si256, __m256i, and)
+IEC_BOOL_VEC(avx2, _mm256, si256, __m256i, or)
+IEC_BOOL_VEC(avx2, _mm256, si256, __m256i, xor)
+
+#define IEC_BOOL_VEC_NOT(isa, pfx, si, vec)                                                       \
+static IEC_BATCH_TARGET_ ## isa size_t iec_bool_not_ ## isa(uint64_t *dst, const uint64_t *a,    \
+        size_t words) {                                                                           \
+    const size_t lanes = sizeof(vec) / sizeof(uint64_t);                                          \
+    const vec ones = pfx ## _set1_epi32(-1);                                                      \
+    size_t i = 0;                                                                                 \
+    for (; i + lanes <= words; i += lanes) {                                                      \
+        vec va = pfx ## _loadu_ ## si((const vec*) (a + i));                                      \
+        pfx ## _storeu_ ## si((vec*) (dst + i), pfx ## _xor_ ## si(va, ones));                    \
+    }                                                                                             \
+    return i;                                                                                     \
+}
+
+IEC_BOOL_VEC_NOT(sse2, _mm, si128, __m128i)
+IEC_BOOL_VEC_NOT(avx2, _mm256, si256, __m256i)
+
+#define IEC_BOOL_RUN_SIMD(op, args)                                                               \
+            switch (iec_batch_level()) {                                                          \
+                case IEC_BATCH_AVX2:                                                              \
+                    done = iec_bool_ ## op ## _avx2 args;                                         \
+                    break;                                                                        \
+                case IEC_BATCH_SSE2:                                                              \
+                    done = iec_bool_ ## op ## _sse2 args;                                         \
+                    break;                                                                        \
+                default:                                                                          \
+                    break;                                                                        \
+            }
+#else
+#define IEC_BOOL_RUN_SIMD(op, args)
+#endif
+/**@}*/
+
+/**
+ * @fn void iec_bool_and(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t words)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param words
+ */
+void iec_bool_and(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t words) {
+    size_t done = 0;
+
+    IEC_BOOL_RUN_SIMD(and, (dst, a, b, words))
+    iec_bool_and_scalar(dst, a, b, done, words);
+}
+
+/**
+ * @fn void iec_bool_or(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t words)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param words
+ */
+void iec_bool_or(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t words) {
+    size_t done = 0;
+
+    IEC_BOOL_RUN_SIMD(or, (dst, a, b, words))
+    iec_bool_or_scalar(dst, a, b, done, words);
+}
+
+/**
+ * @fn void iec_bool_xor(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t words)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @param words
+ */
+void iec_bool_xor(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t words) {
+    size_t done = 0;
+
+    IEC_BOOL_RUN_SIMD(xor, (dst, a, b, words))
+    iec_bool_xor_scalar(dst, a, b, done, words);
+}
+
+/**
+ * @fn void iec_bool_not(uint64_t *dst, const uint64_t *a, size_t count)
+ * @brief NOT of count BOOL. Bits behind count in last word are left 0
+ *
+ * @param dst
+ * @param a
+ * @param count
+ */
+void iec_bool_not(uint64_t *dst, const uint64_t *a, size_t count) {
+    size_t words = IEC_BATCH_MASK_WORDS(count);
+    size_t done = 0;
+
+    IEC_BOOL_RUN_SIMD(not, (dst, a, words))
+    iec_bool_not_scalar(dst, a, done, words);
+    if (count & 63)
+        dst[words - 1] &= (UINT64_C(1) << (count & 63)) - 1;
+}
+
+/**
+ * @fn uint8_t iec_bool_bank_init(iec_bool_bank_t *bank, uint32_t count)
+ * @brief allocate bank of count BOOL, all FALSE
+ *
+ * @param bank
+ * @param count
+ * @return status
+ */
+uint8_t iec_bool_bank_init(iec_bool_bank_t *bank, uint32_t count) {
+    size_t size = IEC_BATCH_MASK_WORDS(count) * sizeof(uint64_t);
+
+    bank->count = 0;
+    bank->words = iec_malloc(size > 0 ? size : sizeof(uint64_t));
+    if (bank->words == NULL)
+        return IEC_ERR;
+    memset(bank->words, 0, size);
+    bank->count = count;
+
+    return IEC_OK;
+}
+
+/**
+ * @fn void iec_bool_bank_release(iec_bool_bank_t *bank)
+ * @brief
+ *
+ * @param bank
+ */
+void iec_bool_bank_release(iec_bool_bank_t *bank) {
+    iec_free(bank->words);
+    bank->words = NULL;
+    bank->count = 0;
+}
+
+/**
+ * @fn static inline bool iec_bool_bank_get(const iec_bool_bank_t *bank, uint32_t index)
+ * @brief
+ *
+ * @param bank
+ * @param index
+ * @return value
+ */
+static inline bool iec_bool_bank_get(const iec_bool_bank_t *bank, uint32_t index) {
+    return (bank->words[index >> 6] >> (index & 63)) & 1;
+}
+
+/**
+ * @fn static inline void iec_bool_bank_set(iec_bool_bank_t *bank, uint32_t index, bool value)
+ * @brief
+ *
+ * @param bank
+ * @param index
+ * @param value
+ */
+static inline void iec_bool_bank_set(iec_bool_bank_t *bank, uint32_t index, bool value) {
+    uint64_t bit = UINT64_C(1) << (index & 63);
+
+    if (value)
+        bank->words[index >> 6] |= bit;
+    else
+        bank->words[index >> 6] &= ~bit;
+}
+
+/**
+ * @fn uint8_t iec_bool_bank_load(const iec_bool_bank_t *bank, uint32_t index, iec_t *var)
+ * @brief copy BOOL index of bank to var, converted to IEC_T_BOOL if needed
+ *
+ * @param bank
+ * @param index
+ * @param var
+ * @return status
+ */
+uint8_t iec_bool_bank_load(const iec_bool_bank_t *bank, uint32_t index, iec_t *var) {
+    if (index >= bank->count)
+        return IEC_ENL;
+
+    if ((*var)->type != IEC_T_BOOL)
+        iec_totype(var, IEC_T_BOOL);
+    (*var)->v_bool = iec_bool_bank_get(bank, index);
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_bool_bank_store(iec_bool_bank_t *bank, uint32_t index, iec_t var)
+ * @brief copy var (ANY_BOOL) to BOOL index of bank
+ *
+ * @param bank
+ * @param index
+ * @param var
+ * @return status
+ */
+uint8_t iec_bool_bank_store(iec_bool_bank_t *bank, uint32_t index, iec_t var) {
+    if (var == NULL || !ANY_BOOL(var->type))
+        return IEC_NAT;
+    if (index >= bank->count)
+        return IEC_ENL;
+
+    iec_bool_bank_set(bank, index, var->v_bool);
+
+    return IEC_OK;
+}
+
+/**
+ * @def IEC_BOOL_BANK_CHECK
+ * @brief check banks have the same size
+ *
+ */
+#define IEC_BOOL_BANK_CHECK(dst, a, b)                                                            \
+            if ((dst)->count != (a)->count || (dst)->count != (b)->count)                         \
+                return IEC_OOR
+
+/**
+ * @fn uint8_t iec_and_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a, const iec_bool_bank_t *b)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @return status
+ */
+uint8_t iec_and_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a, const iec_bool_bank_t *b) {
+    IEC_BOOL_BANK_CHECK(dst, a, b);
+
+    iec_bool_and(dst->words, a->words, b->words, IEC_BATCH_MASK_WORDS(dst->count));
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_or_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a, const iec_bool_bank_t *b)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @return status
+ */
+uint8_t iec_or_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a, const iec_bool_bank_t *b) {
+    IEC_BOOL_BANK_CHECK(dst, a, b);
+
+    iec_bool_or(dst->words, a->words, b->words, IEC_BATCH_MASK_WORDS(dst->count));
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_xor_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a, const iec_bool_bank_t *b)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @param b
+ * @return status
+ */
+uint8_t iec_xor_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a, const iec_bool_bank_t *b) {
+    IEC_BOOL_BANK_CHECK(dst, a, b);
+
+    iec_bool_xor(dst->words, a->words, b->words, IEC_BATCH_MASK_WORDS(dst->count));
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_not_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a)
+ * @brief
+ *
+ * @param dst
+ * @param a
+ * @return status
+ */
+uint8_t iec_not_bank(iec_bool_bank_t *dst, const iec_bool_bank_t *a) {
+    IEC_BOOL_BANK_CHECK(dst, a, a);
+
+    iec_bool_not(dst->words, a->words, dst->count);
+
+    return IEC_OK;
+}
+
+/**
+ * @typedef iec_bits_iter_t
+ * @brief iterator over set bits of a packed BOOL array
+ *
+ */
+typedef struct iec_bits_iter_t {
+    const uint64_t *words; /**< bits */
+    size_t nwords;         /**< number of words */
+    size_t word;           /**< current word */
+    uint64_t bits;         /**< pending bits of current word */
+} iec_bits_iter_t;
+
+/**
+ * @fn static inline void iec_bits_iter_init(iec_bits_iter_t *it, const uint64_t *words, size_t count)
+ * @brief start iteration over first count bits of words. Bits behind count must be 0
+ *
+ * @param it
+ * @param words
+ * @param count
+ */
+static inline void iec_bits_iter_init(iec_bits_iter_t *it, const uint64_t *words, size_t count) {
+    it->words = words;
+    it->nwords = IEC_BATCH_MASK_WORDS(count);
+    it->word = 0;
+    it->bits = it->nwords > 0 ? words[0] : 0;
+}
+
+/**
+ * @fn static inline bool iec_bits_next(iec_bits_iter_t *it, uint32_t *index)
+ * @brief next set bit. Zero words are skipped without looking at their bits
+ *
+ * @param it
+ * @param index
+ * @return false when no more bits
+ */
+static inline bool iec_bits_next(iec_bits_iter_t *it, uint32_t *index) {
+    while (it->bits == 0) {
+        if (++it->word >= it->nwords)
+            return false;
+        it->bits = it->words[it->word];
+    }
+
+    *index = (uint32_t) (it->word * 64 + __builtin_ctzll(it->bits));
+    it->bits &= it->bits - 1;
+
+    return true;
+}
+
+#endif /* IEC_BOOL_BANK_H_ */
@@ -31,6 +31,8 @@
 #ifndef IEC_COMPARISON_H_
 #define IEC_COMPARISON_H_
 
+#include "iec_fastpath.h"
+
 /*
  * Summary:
  *
@@ -41,6 +43,11 @@
  *  LE            ANY_ELEMENTARY          2            Less than or equal to
  *  LT            ANY_ELEMENTARY          2            Less than
  *  NE            ANY_ELEMENTARY          2            Not equal to
+ *
+ *  Operands of different types are compared by iec_compare: exactly as integers (a negative signed value is
+ *  below any unsigned one), in double if one of them is REAL, LREAL or TIME.
+ *  EQ/NE of strings compare characters; hashes (iec_string_set with hash) reject different strings early
+ *  and interned strings (iec_string_intern) compare by pointer.
  */
 
 /**
@@ -56,8 +63,12 @@ uint8_t iec_gt(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_ELEMENTARY,,,,,);
     iec_anytype_allowed(v2, ANY_ELEMENTARY,,,,,);
 
-    iec_totype(result, IEC_T_BOOL);
-    iec_set_value((*result), ((iec_get_value(v1)) > (iec_get_value(v2))));
+    if (v1->type == v2->type && IEC_FAST_GT[v1->type] != NULL)
+        return IEC_FAST_GT[v1->type](result, v1, v2);
+
+    iec_fast_result(result, IEC_T_BOOL);
+    int c = iec_compare(v1, v2);
+    (*result)->v_bool = c == 1;
 
     return IEC_OK;
 }
@@ -75,8 +86,12 @@ uint8_t iec_ge(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_ELEMENTARY,,,,,);
     iec_anytype_allowed(v2, ANY_ELEMENTARY,,,,,);
 
-    iec_totype(result, IEC_T_BOOL);
-    iec_set_value((*result), ((iec_get_value(v1)) >= (iec_get_value(v2))));
+    if (v1->type == v2->type && IEC_FAST_GE[v1->type] != NULL)
+        return IEC_FAST_GE[v1->type](result, v1, v2);
+
+    iec_fast_result(result, IEC_T_BOOL);
+    int c = iec_compare(v1, v2);
+    (*result)->v_bool = c == 0 || c == 1;
 
     return IEC_OK;
 }
@@ -94,8 +109,18 @@ uint8_t iec_eq(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_ELEMENTARY,,,,,);
     iec_anytype_allowed(v2, ANY_ELEMENTARY,,,,,);
 
-    iec_totype(result, IEC_T_BOOL);
-    iec_set_value((*result), ((iec_get_value(v1)) == (iec_get_value(v2))));
+    if (ANY_STRING(v1->type) && ANY_STRING(v2->type)) {
+        iec_fast_result(result, IEC_T_BOOL);
+        (*result)->v_bool = iec_string_equal((string_t*) v1->value, (string_t*) v2->value);
+        return IEC_OK;
+    }
+
+    if (v1->type == v2->type && IEC_FAST_EQ[v1->type] != NULL)
+        return IEC_FAST_EQ[v1->type](result, v1, v2);
+
+    iec_fast_result(result, IEC_T_BOOL);
+    int c = iec_compare(v1, v2);
+    (*result)->v_bool = c == 0;
 
     return IEC_OK;
 }
@@ -113,8 +138,12 @@ uint8_t iec_le(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_ELEMENTARY,,,,,);
     iec_anytype_allowed(v2, ANY_ELEMENTARY,,,,,);
 
-    iec_totype(result, IEC_T_BOOL);
-    iec_set_value((*result), ((iec_get_value(v1)) <= (iec_get_value(v2))));
+    if (v1->type == v2->type && IEC_FAST_LE[v1->type] != NULL)
+        return IEC_FAST_LE[v1->type](result, v1, v2);
+
+    iec_fast_result(result, IEC_T_BOOL);
+    int c = iec_compare(v1, v2);
+    (*result)->v_bool = c == -1 || c == 0;
 
     return IEC_OK;
 }
@@ -132,8 +161,12 @@ uint8_t iec_lt(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_ELEMENTARY,,,,,);
     iec_anytype_allowed(v2, ANY_ELEMENTARY,,,,,);
 
-    iec_totype(result, IEC_T_BOOL);
-    iec_set_value((*result), ((iec_get_value(v1)) < (iec_get_value(v2))));
+    if (v1->type == v2->type && IEC_FAST_LT[v1->type] != NULL)
+        return IEC_FAST_LT[v1->type](result, v1, v2);
+
+    iec_fast_result(result, IEC_T_BOOL);
+    int c = iec_compare(v1, v2);
+    (*result)->v_bool = c == -1;
 
     return IEC_OK;
 }
@@ -151,8 +184,18 @@ uint8_t iec_ne(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_ELEMENTARY,,,,,);
     iec_anytype_allowed(v2, ANY_ELEMENTARY,,,,,);
 
-    iec_totype(result, IEC_T_BOOL);
-    iec_set_value((*result), ((iec_get_value(v1)) != (iec_get_value(v2))));
+    if (ANY_STRING(v1->type) && ANY_STRING(v2->type)) {
+        iec_fast_result(result, IEC_T_BOOL);
+        (*result)->v_bool = !iec_string_equal((string_t*) v1->value, (string_t*) v2->value);
+        return IEC_OK;
+    }
+
+    if (v1->type == v2->type && IEC_FAST_NE[v1->type] != NULL)
+        return IEC_FAST_NE[v1->type](result, v1, v2);
+
+    iec_fast_result(result, IEC_T_BOOL);
+    int c = iec_compare(v1, v2);
+    (*result)->v_bool = c != 0;
 
     return IEC_OK;
 }
@@ -0,0 +1,184 @@
+/**
+ * @file iec_edge.h
+ * @brief Batch edge detection (R_TRIG/F_TRIG) over packed BOOL
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_EDGE_H_
+#define IEC_EDGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iec61131lib.h"
+#include "iec_bool_bank.h"
+
+/*
+ * Summary:
+ *
+ *  Function        Parameter Type   Parameters     Description
+ *
+ *  R_TRIG batch                                    Rising Edge Detector of count inputs
+ *                  CLK packed BOOL  Input          A rising edge sets the bit of Q for one execution.
+ *                  Q   packed BOOL  Output         rising = CLK AND NOT prev
+ *
+ *  F_TRIG batch                                    Falling Edge Detector of count inputs
+ *                  CLK packed BOOL  Input          A falling edge sets the bit of Q for one execution.
+ *                  Q   packed BOOL  Output         falling = NOT CLK AND prev
+ *
+ *  Previous CLK is kept packed in iec_edge_t, one bit for input (the TT_FLAG1 of iec_r_trig/iec_f_trig).
+ *  Initial prev FALSE behaves as iec_r_trig, TRUE as iec_f_trig (first scan with CLK FALSE is an edge).
+ *  Use iec_bits_iter_t over Q to visit only changed inputs.
+ */
+
+/**
+ * @typedef iec_edge_t
+ * @brief edge detector state
+ *
+ */
+typedef struct iec_edge_t {
+    uint64_t *prev; /**< previous CLK */
+    uint32_t count; /**< number of inputs */
+} iec_edge_t;
+
+/**
+ * @fn static inline uint64_t iec_edge_tail(uint32_t count, size_t word)
+ * @brief mask of valid bits of word
+ *
+ * @param count
+ * @param word
+ * @return mask
+ */
+static inline uint64_t iec_edge_tail(uint32_t count, size_t word) {
+    if ((count & 63) == 0 || word + 1 < IEC_BATCH_MASK_WORDS(count))
+        return UINT64_MAX;
+
+    return (UINT64_C(1) << (count & 63)) - 1;
+}
+
+/**
+ * @fn uint8_t iec_edge_init(iec_edge_t *edge, uint32_t count, bool initial)
+ * @brief
+ *
+ * @param edge
+ * @param count
+ * @param initial previous CLK of first scan
+ * @return status
+ */
+uint8_t iec_edge_init(iec_edge_t *edge, uint32_t count, bool initial) {
+    size_t words = IEC_BATCH_MASK_WORDS(count);
+
+    edge->count = 0;
+    edge->prev = iec_malloc(words > 0 ? words * sizeof(uint64_t) : sizeof(uint64_t));
+    if (edge->prev == NULL)
+        return IEC_ERR;
+    for (size_t w = 0; w < words; w++)
+        edge->prev[w] = initial ? iec_edge_tail(count, w) : 0;
+    edge->count = count;
+
+    return IEC_OK;
+}
+
+/**
+ * @fn void iec_edge_release(iec_edge_t *edge)
+ * @brief
+ *
+ * @param edge
+ */
+void iec_edge_release(iec_edge_t *edge) {
+    iec_free(edge->prev);
+    edge->prev = NULL;
+    edge->count = 0;
+}
+
+/**
+ * @fn uint32_t iec_edge_update(iec_edge_t *edge, const uint64_t *clk, uint64_t *rising, uint64_t *falling)
+ * @brief rising = clk & ~prev, falling = ~clk & prev, prev = clk. Bits of clk behind count are ignored
+ *
+ * @param edge
+ * @param clk packed CLK
+ * @param rising packed Q of R_TRIG (may be NULL)
+ * @param falling packed Q of F_TRIG (may be NULL)
+ * @return number of edges (rising and falling)
+ */
+uint32_t iec_edge_update(iec_edge_t *edge, const uint64_t *clk, uint64_t *rising, uint64_t *falling) {
+    size_t words = IEC_BATCH_MASK_WORDS(edge->count);
+    uint32_t edges = 0;
+
+    for (size_t w = 0; w < words; w++) {
+        uint64_t cur = clk[w] & iec_edge_tail(edge->count, w);
+        uint64_t prev = edge->prev[w];
+
+        if (rising != NULL)
+            rising[w] = cur & ~prev;
+        if (falling != NULL)
+            falling[w] = ~cur & prev;
+        edges += __builtin_popcountll(cur ^ prev);
+        edge->prev[w] = cur;
+    }
+
+    return edges;
+}
+
+/**
+ * @fn uint8_t iec_r_trig_batch(iec_bool_bank_t *q, iec_edge_t *edge, const iec_bool_bank_t *clk)
+ * @brief
+ *
+ * @param q
+ * @param edge
+ * @param clk
+ * @return status
+ */
+uint8_t iec_r_trig_batch(iec_bool_bank_t *q, iec_edge_t *edge, const iec_bool_bank_t *clk) {
+    if (q->count != edge->count || clk->count != edge->count)
+        return IEC_OOR;
+
+    iec_edge_update(edge, clk->words, q->words, NULL);
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_f_trig_batch(iec_bool_bank_t *q, iec_edge_t *edge, const iec_bool_bank_t *clk)
+ * @brief
+ *
+ * @param q
+ * @param edge
+ * @param clk
+ * @return status
+ */
+uint8_t iec_f_trig_batch(iec_bool_bank_t *q, iec_edge_t *edge, const iec_bool_bank_t *clk) {
+    if (q->count != edge->count || clk->count != edge->count)
+        return IEC_OOR;
+
+    iec_edge_update(edge, clk->words, NULL, q->words);
+
+    return IEC_OK;
+}
+
+#endif /* IEC_EDGE_H_ */
@@ -0,0 +1,296 @@
+/**
+ * @file iec_fastpath.h
+ * @brief Type specialized operators for operands with types known at compile time
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_FASTPATH_H_
+#define IEC_FASTPATH_H_
+
+#include "iec61131lib.h"
+
+/*
+ * Summary:
+ *
+ *  Function             Parameter Type          Parameters   Description
+ *  ADD_T_T              ANY_NUM                 2            Addition
+ *  SUB_T_T              ANY_NUM                 2            Subtraction
+ *  MUL_T_T              ANY_NUM                 2            Multiplication
+ *  DIV_T_T              ANY_NUM                 2            Division
+ *  MOD_T_T              ANY_INT                 2            Modulo
+ *  GT_T_T .. NE_T_T     ANY_NUM                 2            Comparison
+ *  SHL_T_T, SHR_T_T     ANY_INTEGRAL            2            Shift
+ *
+ *  Both operands are of type T, result is of type T (BOOL for comparisons). Operand types are not checked:
+ *  these are meant for code where types are known at compile time, generic functions remain for the others.
+ *
+ *  iec_add_T_T(result, v1, v2)    operands are iec_t
+ *  iec_add_T(result, a, b)        operands are C values
+ *  iec_fast_add(result, a, b)     select iec_add_T by C type of a (_Generic)
+ */
+
+/**
+ * @name fast path types
+ * @brief X(arg, name, C type, inline member, unsigned type used for arithmetic without overflow, 1 if signed)
+ *
+ */
+/**@{*/
+#ifdef ALLOW_64BITS
+#define IEC_FAST_INTS_64(X, a)                                                                    \
+            X(a, LINT, int64_t, v_int64, uint64_t, 1)                                             \
+            X(a, ULINT, uint64_t, v_uint64, uint64_t, 0)                                          \
+            X(a, LWORD, int64_t, v_int64, uint64_t, 1)
+#else
+#define IEC_FAST_INTS_64(X, a)
+#endif
+#define IEC_FAST_INTS(X, a)                                                                       \
+            X(a, SINT, int8_t, v_int8, uint8_t, 1)                                                \
+            X(a, USINT, uint8_t, v_uint8, uint8_t, 0)                                             \
+            X(a, BYTE, uint8_t, v_uint8, uint8_t, 0)                                              \
+            X(a, INT, int16_t, v_int16, uint16_t, 1)                                              \
+            X(a, UINT, uint16_t, v_uint16, uint16_t, 0)                                           \
+            X(a, WORD, uint16_t, v_uint16, uint16_t, 0)                                           \
+            X(a, DINT, int32_t, v_int32, uint32_t, 1)                                             \
+            X(a, UDINT, uint32_t, v_uint32, uint32_t, 0)                                          \
+            X(a, DWORD, uint32_t, v_uint32, uint32_t, 0)                                          \
+            IEC_FAST_INTS_64(X, a)
+#define IEC_FAST_REALS(X, a)                                                                      \
+            X(a, REAL, float, v_float, float, 1)                                                  \
+            X(a, LREAL, double, v_double, double, 1)
+#define IEC_FAST_NUMS(X, a)                                                                       \
+            IEC_FAST_INTS(X, a)                                                                   \
+            IEC_FAST_REALS(X, a)
+/**@}*/
+
+/**
+ * @fn static inline void iec_fast_result(iec_t *result, iectype_t type)
+ * @brief set result type. Conversion is done only if type change
+ *
+ * @param result
+ * @param type
+ */
+static inline void iec_fast_result(iec_t *result, iectype_t type) {
+    if ((*result)->type != type)
+        iec_totype(result, type);
+}
+
+/**
+ * @name fast path generators
+ * @brief native variant (C operands) and iec_t variant of each operator.
+ *        Integer arithmetic is done in unsigned type, so overflow wraps as in the PLC instead of undefined behavior
+ *
+ */
+/**@{*/
+#define IEC_FAST_OPERANDS(op, name, member)                                                                         \
+static inline uint8_t iec_ ## op ## _ ## name ## _ ## name(iec_t *result, iec_t v1, iec_t v2) {                     \
+    return iec_ ## op ## _ ## name(result, v1->member, v2->member);                                                 \
+}
+
+#define IEC_FAST_ARITH(arg, name, type, member, utype, sgn)                                                         \
+static inline uint8_t iec_add_ ## name(iec_t *result, type a, type b) {                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    (*result)->member = (type) ((utype) a + (utype) b);                                                             \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_sub_ ## name(iec_t *result, type a, type b) {                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    (*result)->member = (type) ((utype) a - (utype) b);                                                             \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_mul_ ## name(iec_t *result, type a, type b) {                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    (*result)->member = (type) (1U * (utype) a * (utype) b);                                                        \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_div_ ## name(iec_t *result, type a, type b) {                                             \
+    if (b == 0)                                                                                                     \
+        return IEC_NAT;                                                                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    if (sgn && b == (type) -1)                                                                                      \
+        (*result)->member = (type) (0U - (utype) a);                                                                \
+    else                                                                                                            \
+        (*result)->member = a / b;                                                                                  \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+IEC_FAST_OPERANDS(add, name, member)                                                                                \
+IEC_FAST_OPERANDS(sub, name, member)                                                                                \
+IEC_FAST_OPERANDS(mul, name, member)                                                                                \
+IEC_FAST_OPERANDS(div, name, member)
+
+#define IEC_FAST_COMPARE(arg, name, type, member, utype, sgn)                                                       \
+static inline uint8_t iec_gt_ ## name(iec_t *result, type a, type b) {                                              \
+    iec_fast_result(result, IEC_T_BOOL);                                                                            \
+    (*result)->v_bool = a > b;                                                                                      \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_ge_ ## name(iec_t *result, type a, type b) {                                              \
+    iec_fast_result(result, IEC_T_BOOL);                                                                            \
+    (*result)->v_bool = a >= b;                                                                                     \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_eq_ ## name(iec_t *result, type a, type b) {                                              \
+    iec_fast_result(result, IEC_T_BOOL);                                                                            \
+    (*result)->v_bool = a == b;                                                                                     \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_le_ ## name(iec_t *result, type a, type b) {                                              \
+    iec_fast_result(result, IEC_T_BOOL);                                                                            \
+    (*result)->v_bool = a <= b;                                                                                     \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_lt_ ## name(iec_t *result, type a, type b) {                                              \
+    iec_fast_result(result, IEC_T_BOOL);                                                                            \
+    (*result)->v_bool = a < b;                                                                                      \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_ne_ ## name(iec_t *result, type a, type b) {                                              \
+    iec_fast_result(result, IEC_T_BOOL);                                                                            \
+    (*result)->v_bool = a != b;                                                                                     \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+IEC_FAST_OPERANDS(gt, name, member)                                                                                 \
+IEC_FAST_OPERANDS(ge, name, member)                                                                                 \
+IEC_FAST_OPERANDS(eq, name, member)                                                                                 \
+IEC_FAST_OPERANDS(le, name, member)                                                                                 \
+IEC_FAST_OPERANDS(lt, name, member)                                                                                 \
+IEC_FAST_OPERANDS(ne, name, member)
+
+/* shift count out of 0 .. bits - 1 gives 0 */
+#define IEC_FAST_INTEGRAL(arg, name, type, member, utype, sgn)                                                      \
+static inline uint8_t iec_mod_ ## name(iec_t *result, type a, type b) {                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    (*result)->member = (b == 0 || (sgn && b == (type) -1)) ? 0 : a % b;                                            \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_shl_ ## name(iec_t *result, type a, type n) {                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    (*result)->member = ((utype) n >= 8 * sizeof(type)) ? 0 : (type) ((utype) a << n);                              \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+static inline uint8_t iec_shr_ ## name(iec_t *result, type a, type n) {                                             \
+    iec_fast_result(result, IEC_T_ ## name);                                                                        \
+    (*result)->member = ((utype) n >= 8 * sizeof(type)) ? 0 : (type) ((utype) a >> n);                              \
+    return IEC_OK;                                                                                                  \
+}                                                                                                                   \
+IEC_FAST_OPERANDS(mod, name, member)                                                                                \
+IEC_FAST_OPERANDS(shl, name, member)                                                                                \
+IEC_FAST_OPERANDS(shr, name, member)
+/**@}*/
+
+IEC_FAST_NUMS(IEC_FAST_ARITH, )
+IEC_FAST_NUMS(IEC_FAST_COMPARE, )
+IEC_FAST_INTS(IEC_FAST_INTEGRAL, )
+
+/**
+ * @name fast path tables
+ * @brief iec_t variant of operator indexed by type of both operands, NULL if there is no fast path for type
+ *
+ */
+/**@{*/
+typedef uint8_t (*iec_fast_fn_t)(iec_t *result, iec_t v1, iec_t v2);
+
+#define IEC_FAST_ENTRY(op, name, type, member, utype, sgn)  [IEC_T_ ## name] = iec_ ## op ## _ ## name ## _ ## name,
+
+static const iec_fast_fn_t IEC_FAST_ADD[IEC_TYPES_COUNT] = { IEC_FAST_NUMS(IEC_FAST_ENTRY, add) };
+static const iec_fast_fn_t IEC_FAST_SUB[IEC_TYPES_COUNT] = { IEC_FAST_NUMS(IEC_FAST_ENTRY, sub) };
+static const iec_fast_fn_t IEC_FAST_MUL[IEC_TYPES_COUNT] = { IEC_FAST_NUMS(IEC_FAST_ENTRY, mul) };
+static const iec_fast_fn_t IEC_FAST_DIV[IEC_TYPES_COUNT] = { IEC_FAST_NUMS(IEC_FAST_ENTRY, div) };
+static const iec_fast_fn_t IEC_FAST_MOD[IEC_TYPES_COUNT] = { IEC_FAST_INTS(IEC_FAST_ENTRY, mod) };
+static const iec_fast_fn_t IEC_FAST_GT[IEC_TYPES_COUNT]  = { IEC_FAST_NUMS(IEC_FAST_ENTRY, gt) };
+static const iec_fast_fn_t IEC_FAST_GE[IEC_TYPES_COUNT]  = { IEC_FAST_NUMS(IEC_FAST_ENTRY, ge) };
+static const iec_fast_fn_t IEC_FAST_EQ[IEC_TYPES_COUNT]  = { IEC_FAST_NUMS(IEC_FAST_ENTRY, eq) };
+static const iec_fast_fn_t IEC_FAST_LE[IEC_TYPES_COUNT]  = { IEC_FAST_NUMS(IEC_FAST_ENTRY, le) };
+static const iec_fast_fn_t IEC_FAST_LT[IEC_TYPES_COUNT]  = { IEC_FAST_NUMS(IEC_FAST_ENTRY, lt) };
+static const iec_fast_fn_t IEC_FAST_NE[IEC_TYPES_COUNT]  = { IEC_FAST_NUMS(IEC_FAST_ENTRY, ne) };
+/**@}*/
+
+/**
+ * @name fast path selection
+ * @brief select native variant by C type of first operand. Integer literals are int, so they select DINT
+ *
+ */
+/**@{*/
+#ifdef ALLOW_64BITS
+#define IEC_FAST_SELECT_INT(op, a)                                                                \
+            _Generic((a),                                                                         \
+                int8_t:   iec_ ## op ## _SINT,                                                    \
+                uint8_t:  iec_ ## op ## _USINT,                                                   \
+                int16_t:  iec_ ## op ## _INT,                                                     \
+                uint16_t: iec_ ## op ## _UINT,                                                    \
+                int32_t:  iec_ ## op ## _DINT,                                                    \
+                uint32_t: iec_ ## op ## _UDINT,                                                   \
+                int64_t:  iec_ ## op ## _LINT,                                                    \
+                uint64_t: iec_ ## op ## _ULINT)
+#define IEC_FAST_SELECT_NUM(op, a)                                                                \
+            _Generic((a),                                                                         \
+                int8_t:   iec_ ## op ## _SINT,                                                    \
+                uint8_t:  iec_ ## op ## _USINT,                                                   \
+                int16_t:  iec_ ## op ## _INT,                                                     \
+                uint16_t: iec_ ## op ## _UINT,                                                    \
+                int32_t:  iec_ ## op ## _DINT,                                                    \
+                uint32_t: iec_ ## op ## _UDINT,                                                   \
+                int64_t:  iec_ ## op ## _LINT,                                                    \
+                uint64_t: iec_ ## op ## _ULINT,                                                   \
+                float:    iec_ ## op ## _REAL,                                                    \
+                double:   iec_ ## op ## _LREAL)
+#else
+#define IEC_FAST_SELECT_INT(op, a)                                                                \
+            _Generic((a),                                                                         \
+                int8_t:   iec_ ## op ## _SINT,                                                    \
+                uint8_t:  iec_ ## op ## _USINT,                                                   \
+                int16_t:  iec_ ## op ## _INT,                                                     \
+                uint16_t: iec_ ## op ## _UINT,                                                    \
+                int32_t:  iec_ ## op ## _DINT,                                                    \
+                uint32_t: iec_ ## op ## _UDINT)
+#define IEC_FAST_SELECT_NUM(op, a)                                                                \
+            _Generic((a),                                                                         \
+                int8_t:   iec_ ## op ## _SINT,                                                    \
+                uint8_t:  iec_ ## op ## _USINT,                                                   \
+                int16_t:  iec_ ## op ## _INT,                                                     \
+                uint16_t: iec_ ## op ## _UINT,                                                    \
+                int32_t:  iec_ ## op ## _DINT,                                                    \
+                uint32_t: iec_ ## op ## _UDINT,                                                   \
+                float:    iec_ ## op ## _REAL,                                                    \
+                double:   iec_ ## op ## _LREAL)
+#endif
+
+#define iec_fast_add(result, a, b)  IEC_FAST_SELECT_NUM(add, a)((result), (a), (b))
+#define iec_fast_sub(result, a, b)  IEC_FAST_SELECT_NUM(sub, a)((result), (a), (b))
+#define iec_fast_mul(result, a, b)  IEC_FAST_SELECT_NUM(mul, a)((result), (a), (b))
+#define iec_fast_div(result, a, b)  IEC_FAST_SELECT_NUM(div, a)((result), (a), (b))
+#define iec_fast_mod(result, a, b)  IEC_FAST_SELECT_INT(mod, a)((result), (a), (b))
+#define iec_fast_gt(result, a, b)   IEC_FAST_SELECT_NUM(gt, a)((result), (a), (b))
+#define iec_fast_ge(result, a, b)   IEC_FAST_SELECT_NUM(ge, a)((result), (a), (b))
+#define iec_fast_eq(result, a, b)   IEC_FAST_SELECT_NUM(eq, a)((result), (a), (b))
+#define iec_fast_le(result, a, b)   IEC_FAST_SELECT_NUM(le, a)((result), (a), (b))
+#define iec_fast_lt(result, a, b)   IEC_FAST_SELECT_NUM(lt, a)((result), (a), (b))
+#define iec_fast_ne(result, a, b)   IEC_FAST_SELECT_NUM(ne, a)((result), (a), (b))
+#define iec_fast_shl(result, a, n)  IEC_FAST_SELECT_INT(shl, a)((result), (a), (n))
+#define iec_fast_shr(result, a, n)  IEC_FAST_SELECT_INT(shr, a)((result), (a), (n))
+/**@}*/
+
+#endif /* IEC_FASTPATH_H_ */
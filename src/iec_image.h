@@ -0,0 +1,438 @@
+/**
+ * @file iec_image.h
+ * @brief Process image: variables of each type stored in contiguous arrays and addressed by handles
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_IMAGE_H_
+#define IEC_IMAGE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "iec61131lib.h"
+
+/*
+ * Summary:
+ *
+ *  Values of each inline type (see IEC_VALUE_SIZE) are kept in one array per type, tt flags in a parallel array.
+ *  A handle holds type and index, so a variable is found without pointer chasing and whole image operations
+ *  (copy in, copy out, change of value) are linear sweeps over memory.
+ *
+ *  Existing iec_* functions are used through a view: a struct iec_t on the stack loaded from the image
+ *  (iec_image_view) and written back (iec_image_commit), or through iec_image_call1/iec_image_call2.
+ */
+
+/**
+ * @name handle
+ * @brief type in high 8 bits, index in low 24 bits
+ *
+ */
+/**@{*/
+typedef uint32_t iec_handle_t;
+
+#define IEC_HANDLE(type, index)     (((iec_handle_t) (type) << 24) | ((index) & 0x00FFFFFF))
+#define IEC_HANDLE_TYPE(handle)     ((iectype_t) ((handle) >> 24))
+#define IEC_HANDLE_INDEX(handle)    ((handle) & 0x00FFFFFF)
+#define IEC_HANDLE_MAX_INDEX        0x00FFFFFF
+/**@}*/
+
+/**
+ * @def IEC_IMAGE_RESERVE
+ * @brief minimum capacity allocated for a type
+ *
+ */
+#ifndef IEC_IMAGE_RESERVE
+#define IEC_IMAGE_RESERVE 64
+#endif
+
+/**
+ * @typedef iec_image_t
+ * @brief process image
+ *
+ */
+typedef struct iec_image_t {
+    uint8_t *data[IEC_TYPES_COUNT];     /**< values of type */
+    uint8_t *prev[IEC_TYPES_COUNT];     /**< values at last change of value sweep */
+    uint8_t *tt[IEC_TYPES_COUNT];       /**< tt flags */
+    uint32_t count[IEC_TYPES_COUNT];    /**< variables of type */
+    uint32_t capacity[IEC_TYPES_COUNT]; /**< */
+} iec_image_t;
+
+/**
+ * @typedef iec_fn1_t
+ * @brief function with one operand (ABS, SQRT, ...)
+ *
+ */
+typedef uint8_t (*iec_fn1_t)(iec_t *result, iec_t v1);
+
+/**
+ * @typedef iec_fn2_t
+ * @brief function with two operands (SUB, DIV, GT, ...)
+ *
+ */
+typedef uint8_t (*iec_fn2_t)(iec_t *result, iec_t v1, iec_t v2);
+
+/**
+ * @fn void iec_image_init(iec_image_t *image)
+ * @brief
+ *
+ * @param image
+ */
+void iec_image_init(iec_image_t *image) {
+    memset(image, 0, sizeof(iec_image_t));
+}
+
+/**
+ * @fn void iec_image_release(iec_image_t *image)
+ * @brief
+ *
+ * @param image
+ */
+void iec_image_release(iec_image_t *image) {
+    for (int type = 0; type < IEC_TYPES_COUNT; type++) {
+        iec_free(image->data[type]);
+        iec_free(image->prev[type]);
+        iec_free(image->tt[type]);
+    }
+    memset(image, 0, sizeof(iec_image_t));
+}
+
+/**
+ * @fn static inline void* iec_image_grow(void *array, size_t used, size_t size)
+ * @brief move array to new storage of size bytes, new part is zeroed
+ *
+ * @param array
+ * @param used
+ * @param size
+ * @return new array or NULL
+ */
+static inline void* iec_image_grow(void *array, size_t used, size_t size) {
+    uint8_t *grown = iec_malloc(size);
+
+    if (grown == NULL)
+        return NULL;
+    if (array != NULL)
+        memcpy(grown, array, used);
+    memset(grown + used, 0, size - used);
+    iec_free(array);
+
+    return grown;
+}
+
+/**
+ * @fn uint8_t iec_image_reserve(iec_image_t *image, iectype_t type, uint32_t capacity)
+ * @brief reserve storage for capacity variables of type
+ *
+ * @param image
+ * @param type
+ * @param capacity
+ * @return status
+ */
+uint8_t iec_image_reserve(iec_image_t *image, iectype_t type, uint32_t capacity) {
+    if (type >= IEC_TYPES_COUNT || IEC_VALUE_SIZE[type] == 0 || capacity > IEC_HANDLE_MAX_INDEX + 1)
+        return IEC_NAT;
+    if (capacity < IEC_IMAGE_RESERVE)
+        capacity = IEC_IMAGE_RESERVE;
+    if (capacity <= image->capacity[type])
+        return IEC_OK;
+
+    size_t size = IEC_VALUE_SIZE[type];
+    size_t used = image->count[type];
+    uint8_t *data = iec_image_grow(image->data[type], used * size, capacity * size);
+    if (data == NULL)
+        return IEC_ERR;
+    image->data[type] = data;
+    uint8_t *prev = iec_image_grow(image->prev[type], used * size, capacity * size);
+    if (prev == NULL)
+        return IEC_ERR;
+    image->prev[type] = prev;
+    uint8_t *tt = iec_image_grow(image->tt[type], used, capacity);
+    if (tt == NULL)
+        return IEC_ERR;
+    image->tt[type] = tt;
+
+    image->capacity[type] = capacity;
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_image_add(iec_image_t *image, iectype_t type, iec_handle_t *handle)
+ * @brief add a variable of type, initialized to 0
+ *
+ * @param image
+ * @param type
+ * @param handle
+ * @return status
+ */
+uint8_t iec_image_add(iec_image_t *image, iectype_t type, iec_handle_t *handle) {
+    if (type >= IEC_TYPES_COUNT || IEC_VALUE_SIZE[type] == 0)
+        return IEC_NAT;
+
+    if (image->count[type] == image->capacity[type]) {
+        uint8_t res = iec_image_reserve(image, type, image->capacity[type] * 2);
+        if (res != IEC_OK)
+            return res;
+    }
+
+    (*handle) = IEC_HANDLE(type, image->count[type]);
+    image->count[type]++;
+
+    return IEC_OK;
+}
+
+/**
+ * @fn static inline bool iec_image_valid(iec_image_t *image, iec_handle_t handle)
+ * @brief
+ *
+ * @param image
+ * @param handle
+ * @return true if handle is a variable of image
+ */
+static inline bool iec_image_valid(iec_image_t *image, iec_handle_t handle) {
+    return IEC_HANDLE_TYPE(handle) < IEC_TYPES_COUNT && IEC_HANDLE_INDEX(handle) < image->count[IEC_HANDLE_TYPE(handle)];
+}
+
+/**
+ * @fn static inline void* iec_image_ptr(iec_image_t *image, iec_handle_t handle)
+ * @brief pointer to value of variable. Valid until next iec_image_add/iec_image_reserve of the same type
+ *
+ * @param image
+ * @param handle
+ * @return pointer to value
+ */
+static inline void* iec_image_ptr(iec_image_t *image, iec_handle_t handle) {
+    iectype_t type = IEC_HANDLE_TYPE(handle);
+    return image->data[type] + (size_t) IEC_HANDLE_INDEX(handle) * IEC_VALUE_SIZE[type];
+}
+
+/**
+ * @fn uint8_t iec_image_view(iec_image_t *image, iec_handle_t handle, iec_t view)
+ * @brief load variable into view, a struct iec_t not owned by the image (usually on stack)
+ *
+ * @param image
+ * @param handle
+ * @param view
+ * @return status
+ */
+uint8_t iec_image_view(iec_image_t *image, iec_handle_t handle, iec_t view) {
+    if (!iec_image_valid(image, handle))
+        return IEC_ENL;
+
+    iectype_t type = IEC_HANDLE_TYPE(handle);
+    view->type = type;
+    view->any_type = IEC_ANYTYPE(type);
+    view->tt = image->tt[type][IEC_HANDLE_INDEX(handle)];
+    view->v_raw = 0;
+    memcpy(&view->value, iec_image_ptr(image, handle), IEC_VALUE_SIZE[type]);
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_image_commit(iec_image_t *image, iec_handle_t handle, iec_t view)
+ * @brief write view back to variable. View is converted if its type differs from variable type
+ *
+ * @param image
+ * @param handle
+ * @param view
+ * @return status
+ */
+uint8_t iec_image_commit(iec_image_t *image, iec_handle_t handle, iec_t view) {
+    if (!iec_image_valid(image, handle))
+        return IEC_ENL;
+
+    iectype_t type = IEC_HANDLE_TYPE(handle);
+    if (view->type != type) {
+        if (IEC_T_EXTERNAL(view->type))
+            return IEC_NAT;
+        iec_totype(&view, type);
+    }
+
+    image->tt[type][IEC_HANDLE_INDEX(handle)] = view->tt;
+    memcpy(iec_image_ptr(image, handle), &view->value, IEC_VALUE_SIZE[type]);
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_image_call1(iec_image_t *image, iec_fn1_t fn, iec_handle_t result, iec_handle_t v1)
+ * @brief result = fn(v1) on image variables
+ *
+ * @param image
+ * @param fn
+ * @param result
+ * @param v1
+ * @return status
+ */
+uint8_t iec_image_call1(iec_image_t *image, iec_fn1_t fn, iec_handle_t result, iec_handle_t v1) {
+    struct iec_t r, a;
+    iec_t pr = &r;
+    uint8_t res;
+
+    if ((res = iec_image_view(image, result, &r)) != IEC_OK || (res = iec_image_view(image, v1, &a)) != IEC_OK)
+        return res;
+    if ((res = fn(&pr, &a)) != IEC_OK)
+        return res;
+
+    return iec_image_commit(image, result, pr);
+}
+
+/**
+ * @fn uint8_t iec_image_call2(iec_image_t *image, iec_fn2_t fn, iec_handle_t result, iec_handle_t v1, iec_handle_t v2)
+ * @brief result = fn(v1, v2) on image variables
+ *
+ * @param image
+ * @param fn
+ * @param result
+ * @param v1
+ * @param v2
+ * @return status
+ */
+uint8_t iec_image_call2(iec_image_t *image, iec_fn2_t fn, iec_handle_t result, iec_handle_t v1, iec_handle_t v2) {
+    struct iec_t r, a, b;
+    iec_t pr = &r;
+    uint8_t res;
+
+    if ((res = iec_image_view(image, result, &r)) != IEC_OK || (res = iec_image_view(image, v1, &a)) != IEC_OK
+            || (res = iec_image_view(image, v2, &b)) != IEC_OK)
+        return res;
+    if ((res = fn(&pr, &a, &b)) != IEC_OK)
+        return res;
+
+    return iec_image_commit(image, result, pr);
+}
+
+/**
+ * @fn uint8_t iec_image_copy_in(iec_image_t *image, iectype_t type, uint32_t first, const void *src, uint32_t n)
+ * @brief copy n values from src (C array of type) to variables first .. first + n - 1 of type
+ *
+ * @param image
+ * @param type
+ * @param first
+ * @param src
+ * @param n
+ * @return status
+ */
+uint8_t iec_image_copy_in(iec_image_t *image, iectype_t type, uint32_t first, const void *src, uint32_t n) {
+    if (type >= IEC_TYPES_COUNT || (uint64_t) first + n > image->count[type])
+        return IEC_ENL;
+
+    memcpy(image->data[type] + (size_t) first * IEC_VALUE_SIZE[type], src, (size_t) n * IEC_VALUE_SIZE[type]);
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_image_copy_out(iec_image_t *image, iectype_t type, uint32_t first, void *dst, uint32_t n)
+ * @brief copy variables first .. first + n - 1 of type to dst (C array of type)
+ *
+ * @param image
+ * @param type
+ * @param first
+ * @param dst
+ * @param n
+ * @return status
+ */
+uint8_t iec_image_copy_out(iec_image_t *image, iectype_t type, uint32_t first, void *dst, uint32_t n) {
+    if (type >= IEC_TYPES_COUNT || (uint64_t) first + n > image->count[type])
+        return IEC_ENL;
+
+    memcpy(dst, image->data[type] + (size_t) first * IEC_VALUE_SIZE[type], (size_t) n * IEC_VALUE_SIZE[type]);
+
+    return IEC_OK;
+}
+
+/**
+ * @def IEC_IMAGE_COV
+ * @brief change of value sweep over elements of C type
+ *
+ */
+#define IEC_IMAGE_COV(ctype)                                                                      \
+            do {                                                                                  \
+                const ctype *cur = (const ctype*) image->data[type];                              \
+                ctype *old = (ctype*) image->prev[type];                                          \
+                for (uint32_t i = 0; i < count && found < max; i++) {                             \
+                    if (cur[i] != old[i]) {                                                       \
+                        old[i] = cur[i];                                                          \
+                        changed[found++] = IEC_HANDLE(type, i);                                   \
+                    }                                                                             \
+                }                                                                                 \
+            } while (0)
+
+/**
+ * @fn uint32_t iec_image_cov(iec_image_t *image, iectype_t type, iec_handle_t *changed, uint32_t max)
+ * @brief find variables of type changed since last sweep. Values are compared bitwise. Up to max handles are
+ *        stored in changed, the others are reported in next sweep
+ *
+ * @param image
+ * @param type
+ * @param changed
+ * @param max
+ * @return number of handles stored in changed
+ */
+uint32_t iec_image_cov(iec_image_t *image, iectype_t type, iec_handle_t *changed, uint32_t max) {
+    uint32_t found = 0;
+
+    if (type >= IEC_TYPES_COUNT)
+        return 0;
+
+    uint32_t count = image->count[type];
+    switch (IEC_VALUE_SIZE[type]) {
+        case 1:
+            IEC_IMAGE_COV(uint8_t);
+            break;
+        case 2:
+            IEC_IMAGE_COV(uint16_t);
+            break;
+        case 4:
+            IEC_IMAGE_COV(uint32_t);
+            break;
+        case 8:
+            IEC_IMAGE_COV(uint64_t);
+            break;
+        default:
+            break;
+    }
+
+    return found;
+}
+
+/**
+ * @fn void iec_image_snapshot(iec_image_t *image)
+ * @brief take current values as reference for next change of value sweep
+ *
+ * @param image
+ */
+void iec_image_snapshot(iec_image_t *image) {
+    for (int type = 0; type < IEC_TYPES_COUNT; type++) {
+        if (image->count[type] > 0)
+            memcpy(image->prev[type], image->data[type], (size_t) image->count[type] * IEC_VALUE_SIZE[type]);
+    }
+}
+
+#endif /* IEC_IMAGE_H_ */
@@ -0,0 +1,162 @@
+/**
+ * @file iec_scan.h
+ * @brief Scan cycle context: one clock snapshot per cycle
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_SCAN_H_
+#define IEC_SCAN_H_
+
+#include <stdint.h>
+
+#include "iec61131lib.h"
+#include "iec_hardware.h"
+
+/*
+ * Summary:
+ *
+ *  iec_scan_begin() reads the clock once at cycle start and makes the context current: timer blocks
+ *  (iec_tp, iec_ton, iec_tof) then read time from it, so all instances of a cycle see the same
+ *  timestamp and no clock call is made per instance. Without a current context they read hw_millis().
+ *
+ *  The context also gives the time between the start of this cycle and the previous one, for
+ *  integrators (PID, ramps, ...).
+ */
+
+/**
+ * @typedef iec_scan_t
+ * @brief scan cycle context
+ *
+ */
+typedef struct iec_scan_t {
+    uint64_t ms;      /**< cycle start (ms) */
+    uint64_t us;      /**< cycle start (us) */
+    uint64_t prev_ms; /**< previous cycle start (ms) */
+    uint64_t prev_us; /**< previous cycle start (us) */
+    uint64_t cycle;   /**< cycles started */
+} iec_scan_t;
+
+/**
+ * @var iec_scan_current
+ * @brief context of running cycle of calling thread, NULL if none
+ *
+ */
+static IEC_THREAD_LOCAL iec_scan_t *iec_scan_current = NULL;
+
+/**
+ * @fn static inline void iec_scan_init(iec_scan_t *scan)
+ * @brief
+ *
+ * @param scan
+ */
+static inline void iec_scan_init(iec_scan_t *scan) {
+    scan->ms = scan->prev_ms = 0;
+    scan->us = scan->prev_us = 0;
+    scan->cycle = 0;
+}
+
+/**
+ * @fn static inline void iec_scan_begin(iec_scan_t *scan)
+ * @brief take clock snapshot and make scan the current context
+ *
+ * @param scan
+ */
+static inline void iec_scan_begin(iec_scan_t *scan) {
+    uint64_t ms = hw_millis();
+    uint64_t us = hw_micros();
+
+    scan->prev_ms = scan->cycle > 0 ? scan->ms : ms;
+    scan->prev_us = scan->cycle > 0 ? scan->us : us;
+    scan->ms = ms;
+    scan->us = us;
+    scan->cycle++;
+    iec_scan_current = scan;
+}
+
+/**
+ * @fn static inline void iec_scan_end(iec_scan_t *scan)
+ * @brief scan is no more the current context
+ *
+ * @param scan
+ */
+static inline void iec_scan_end(iec_scan_t *scan) {
+    if (iec_scan_current == scan)
+        iec_scan_current = NULL;
+}
+
+/**
+ * @fn static inline uint64_t iec_scan_millis(void)
+ * @brief time (ms) of current cycle, or hw_millis() if no current context
+ *
+ * @return time
+ */
+static inline uint64_t iec_scan_millis(void) {
+    return iec_scan_current != NULL ? iec_scan_current->ms : hw_millis();
+}
+
+/**
+ * @fn static inline uint64_t iec_scan_delta_ms(const iec_scan_t *scan)
+ * @brief time from previous cycle start (0 on first cycle). 32 bits clock wrap is handled
+ *
+ * @param scan
+ * @return ms
+ */
+static inline uint64_t iec_scan_delta_ms(const iec_scan_t *scan) {
+#ifdef ALLOW_64BITS
+    return scan->ms - scan->prev_ms;
+#else
+    return (uint32_t) (scan->ms - scan->prev_ms);
+#endif
+}
+
+/**
+ * @fn static inline uint64_t iec_scan_delta_us(const iec_scan_t *scan)
+ * @brief time from previous cycle start (0 on first cycle). 32 bits clock wrap is handled
+ *
+ * @param scan
+ * @return us
+ */
+static inline uint64_t iec_scan_delta_us(const iec_scan_t *scan) {
+#ifdef ALLOW_64BITS
+    return scan->us - scan->prev_us;
+#else
+    return (uint32_t) (scan->us - scan->prev_us);
+#endif
+}
+
+/**
+ * @fn static inline double iec_scan_delta_s(const iec_scan_t *scan)
+ * @brief time from previous cycle start in seconds, for integrators
+ *
+ * @param scan
+ * @return s
+ */
+static inline double iec_scan_delta_s(const iec_scan_t *scan) {
+    return (double) iec_scan_delta_us(scan) / 1e6;
+}
+
+#endif /* IEC_SCAN_H_ */
@@ -47,20 +47,90 @@
 
 /**
  * @fn uint8_t iec_move(iec_t *to, iec_t from)
- * @brief
+ * @brief Assign one value to another. Destination container and storage are reused: inline values are copied and
+ *        string buffers are overwritten if they have enough capacity
  *
  * @param to
  * @param from
  * @return status
  */
 uint8_t iec_move(iec_t *to, iec_t from) {
-    iec_deinit(to);
-    (*to) = IEC_ALLOC;
-    iec_init(to, from->type);
+    if (from == NULL)
+        return IEC_NLL;
 
+    if (*to == NULL) {
+        (*to) = IEC_ALLOC;
+        if (*to == NULL)
+            return IEC_ERR;
+        iec_init(to, IEC_T_NULL);
+    }
+
+    if (*to == from)
+        return IEC_OK;
+
+    if ((*to)->type != from->type && (IEC_T_EXTERNAL((*to)->type) || IEC_T_EXTERNAL(from->type))) {
+        iec_free_value(to);
+        (*to)->type = from->type;
+        iec_new_value(&((*to)->value), from->type);
+    }
+
+    (*to)->type = from->type;
     (*to)->tt = from->tt;
     (*to)->any_type = from->any_type;
-    iec_set_value((*to), iec_get_value(from));
+
+    if (!IEC_T_EXTERNAL(from->type)) {
+        (*to)->v_raw = from->v_raw;
+        return IEC_OK;
+    }
+
+    if (ANY_STRING(from->type)) {
+        string_t *dst = (string_t*) ((*to)->value);
+        string_t *src = (string_t*) (from->value);
+
+        dst->wstring = src->wstring;
+        if (src->str == NULL) {
+            dst->str = NULL;
+            dst->len = 0;
+            dst->hash = 0;
+            dst->interned = false;
+            return IEC_OK;
+        }
+
+        // interned storage is shared, not copied
+        if (src->interned && (dst->max == 0 || src->len <= dst->max)) {
+            dst->str = src->str;
+            dst->len = src->len;
+            dst->hash = src->hash;
+            dst->interned = true;
+            return IEC_OK;
+        }
+
+        uint8_t status = iec_string_copy(dst, stringValue(src->str), stringLength(src->str));
+        if (status == IEC_OK)
+            dst->hash = src->hash;
+
+        return status;
+    }
+
+    memcpy((*to)->value, from->value, iec_external_size(from->type));
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_sel_ref(iec_t *selected, iec_t v1, iec_t v2, iec_t v3)
+ * @brief select v2 or v3 without copy. selected borrows the input and must be read only
+ *
+ * @param selected
+ * @param v1
+ * @param v2
+ * @param v3
+ * @return status
+ */
+uint8_t iec_sel_ref(iec_t *selected, iec_t v1, iec_t v2, iec_t v3) {
+    iec_type_allowed(v1, IEC_T_BOOL);
+
+    (*selected) = iec_get_int(v1) ? v3 : v2;
 
     return IEC_OK;
 }
@@ -76,16 +146,64 @@ uint8_t iec_move(iec_t *to, iec_t from) {
  * @return status
  */
 uint8_t iec_sel(iec_t *result, iec_t v1, iec_t v2, iec_t v3) {
-    iec_type_allowed(v1, IEC_T_BOOL);
+    iec_t selected;
+    uint8_t res = iec_sel_ref(&selected, v1, v2, v3);
 
-    if (iec_get_value(v1))
-        iec_move(result, v3);
-    else
-        iec_move(result, v2);
+    if (res != IEC_OK)
+        return res;
+
+    return iec_move(result, selected);
+}
+
+/**
+ * @fn uint8_t iec_max_index(size_t *index, iec_t *args, size_t n)
+ * @brief index of highest input, first one if repeated. No copy
+ *
+ * @param index
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_max_index(size_t *index, iec_t *args, size_t n) {
+    if (index == NULL || args == NULL)
+        return IEC_NLL;
+    if (n == 0)
+        return IEC_ENL;
+
+    iec_anytype_allowed(args[0], ANY_NUM,,,,,);
+    (*index) = 0;
+
+    for (size_t i = 1; i < n; i++) {
+        iec_anytype_allowed(args[i], ANY_NUM,,,,,);
+        if (iec_compare(args[*index], args[i]) == -1)
+            (*index) = i;
+    }
 
     return IEC_OK;
 }
 
+/**
+ * @fn uint8_t iec_max_n(iec_t *result, iec_t *args, size_t n)
+ * @brief Highest value of n inputs
+ *
+ * @param result
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_max_n(iec_t *result, iec_t *args, size_t n) {
+    if (*result == NULL)
+        return IEC_NLL;
+
+    size_t index;
+    uint8_t res = iec_max_index(&index, args, n);
+
+    if (res != IEC_OK)
+        return res;
+
+    return iec_move(result, args[index]);
+}
+
 /**
  * @fn uint8_t iec_max(iec_t *result, stack_t *list)
  * @brief
@@ -95,26 +213,64 @@ uint8_t iec_sel(iec_t *result, iec_t v1, iec_t v2, iec_t v3) {
  * @return status
  */
 uint8_t iec_max(iec_t *result, stack_t *list) {
-    if (*result == NULL || *list == NULL)
+    if (*result == NULL || list == NULL || *list == NULL)
         return IEC_NLL;
 
-    iec_t tmp = IEC_ALLOC;
-    iec_init(&tmp, IEC_T_NULL);
-    iec_move(result, (iec_t) stack_pop(*list));
-    iec_anytype_allowed(*result, ANY_NUM,,,,,);
+    uint8_t res = iec_max_n(result, (iec_t*) stack_items(*list), stack_size(*list));
+    stack_flush(*list);
 
-    while (!stack_empty(*list)) {
-        iec_move(&tmp, (iec_t) stack_pop(*list));
-        iec_anytype_allowed(tmp, ANY_NUM,,,,,);
-        if ((iec_get_value(*result)) < (iec_get_value(tmp))) {
-            iec_move(result, tmp);
-        }
+    return res;
+}
+
+/**
+ * @fn uint8_t iec_min_index(size_t *index, iec_t *args, size_t n)
+ * @brief index of lowest input, first one if repeated. No copy
+ *
+ * @param index
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_min_index(size_t *index, iec_t *args, size_t n) {
+    if (index == NULL || args == NULL)
+        return IEC_NLL;
+    if (n == 0)
+        return IEC_ENL;
+
+    iec_anytype_allowed(args[0], ANY_NUM,,,,,);
+    (*index) = 0;
+
+    for (size_t i = 1; i < n; i++) {
+        iec_anytype_allowed(args[i], ANY_NUM,,,,,);
+        if (iec_compare(args[*index], args[i]) == 1)
+            (*index) = i;
     }
 
-    iec_deinit(&tmp);
     return IEC_OK;
 }
 
+/**
+ * @fn uint8_t iec_min_n(iec_t *result, iec_t *args, size_t n)
+ * @brief Lowest value of n inputs
+ *
+ * @param result
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_min_n(iec_t *result, iec_t *args, size_t n) {
+    if (*result == NULL)
+        return IEC_NLL;
+
+    size_t index;
+    uint8_t res = iec_min_index(&index, args, n);
+
+    if (res != IEC_OK)
+        return res;
+
+    return iec_move(result, args[index]);
+}
+
 /**
  * @fn uint8_t iec_min(iec_t *result, stack_t *list)
  * @brief
@@ -124,23 +280,37 @@ uint8_t iec_max(iec_t *result, stack_t *list) {
  * @return status
  */
 uint8_t iec_min(iec_t *result, stack_t *list) {
-    if (*result == NULL || list == NULL)
+    if (*result == NULL || list == NULL || *list == NULL)
         return IEC_NLL;
 
-    iec_t tmp = IEC_ALLOC;
-    iec_init(&tmp, IEC_T_NULL);
-    iec_move(result, (iec_t) stack_pop(*list));
-    iec_anytype_allowed(tmp, ANY_NUM,,,,,);
+    uint8_t res = iec_min_n(result, (iec_t*) stack_items(*list), stack_size(*list));
+    stack_flush(*list);
 
-    while (!stack_empty(*list)) {
-        iec_move(&tmp, (iec_t) stack_pop(*list));
-        iec_anytype_allowed(*result, ANY_NUM,,,,,);
-        if ((iec_get_value(*result)) > (iec_get_value(tmp))) {
-            iec_move(result, tmp);
-        }
-    }
+    return res;
+}
+
+/**
+ * @fn uint8_t iec_limit_ref(iec_t *selected, iec_t v, iec_t min, iec_t max)
+ * @brief select v, min or max without copy. selected borrows the input and must be read only
+ *
+ * @param selected
+ * @param v
+ * @param min
+ * @param max
+ * @return status
+ */
+uint8_t iec_limit_ref(iec_t *selected, iec_t v, iec_t min, iec_t max) {
+    iec_anytype_allowed(v, ANY_NUM,,,,,);
+    iec_anytype_allowed(min, ANY_NUM,,,,,);
+    iec_anytype_allowed(max, ANY_NUM,,,,,);
+
+    if (iec_compare(v, min) == -1)
+        (*selected) = min;
+    else if (iec_compare(v, max) == 1)
+        (*selected) = max;
+    else
+        (*selected) = v;
 
-    iec_deinit(&tmp);
     return IEC_OK;
 }
 
@@ -155,23 +325,78 @@ uint8_t iec_min(iec_t *result, stack_t *list) {
  * @return status
  */
 uint8_t iec_limit(iec_t *result, iec_t v, iec_t min, iec_t max) {
-    iec_anytype_allowed(v, ANY_NUM,,,,,);
-    iec_anytype_allowed(min, ANY_NUM,,,,,);
-    iec_anytype_allowed(max, ANY_NUM,,,,,);
+    iec_t selected;
+    uint8_t res = iec_limit_ref(&selected, v, min, max);
 
-    if ((iec_get_value(v)) < (iec_get_value(min)))
-        iec_move(result, min);
-    else if ((iec_get_value(v)) > (iec_get_value(max)))
-        iec_move(result, max);
-    else
-        iec_move(result, v);
+    if (res != IEC_OK)
+        return res;
+
+    return iec_move(result, selected);
+}
+
+/**
+ * @fn static inline size_t iec_mux_index(iec_t v1, size_t n)
+ * @brief selector K clamped to 0 .. n - 1
+ *
+ * @param v1
+ * @param n
+ * @return index
+ */
+static inline size_t iec_mux_index(iec_t v1, size_t n) {
+    int64_t k = iec_get_int(v1);
+
+    if (k < 0)
+        return 0;
+    if ((uint64_t) k >= n)
+        return n - 1;
+
+    return k;
+}
+
+/**
+ * @fn uint8_t iec_mux_ref(iec_t *selected, iec_t v1, iec_t *args, size_t n)
+ * @brief select args[K] without copy. selected borrows the input and is valid while args is
+ *
+ * @param selected
+ * @param v1
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_mux_ref(iec_t *selected, iec_t v1, iec_t *args, size_t n) {
+    iec_anytype_allowed(v1, ANY_INT,,,,,);
+
+    if (args == NULL || n == 0)
+        return IEC_ENL;
+
+    (*selected) = args[iec_mux_index(v1, n)];
 
     return IEC_OK;
 }
 
+/**
+ * @fn uint8_t iec_mux_n(iec_t *result, iec_t v1, iec_t *args, size_t n)
+ * @brief copy args[K] to result, args[0] is input 0. K is clamped to 0 .. n - 1. Only the selected input is read
+ *
+ * @param result
+ * @param v1
+ * @param args
+ * @param n
+ * @return status
+ */
+uint8_t iec_mux_n(iec_t *result, iec_t v1, iec_t *args, size_t n) {
+    iec_t selected;
+    uint8_t res = iec_mux_ref(&selected, v1, args, n);
+
+    if (res != IEC_OK)
+        return res;
+
+    return iec_move(result, selected);
+}
+
 /**
  * @fn uint8_t iec_mux(iec_t *result, iec_t v1, stack_t *list)
- * @brief
+ * @brief inputs are numbered in pop order (last pushed is input 0)
  *
  * @param result
  * @param v1
@@ -181,22 +406,14 @@ uint8_t iec_limit(iec_t *result, iec_t v, iec_t min, iec_t max) {
 uint8_t iec_mux(iec_t *result, iec_t v1, stack_t *list) {
     iec_anytype_allowed(v1, ANY_INT,,,,,);
 
-    if (iec_get_value(v1) <= 0) {
-        iec_move(result, (iec_t) stack_pop(*list));
-        stack_flush(*list);
-        return IEC_OK;
-    }
-
-    maxuint_t cnt = iec_get_value(v1);
-    while (!stack_empty(*list)) {
-        if (cnt-- == 0)
-            break;
-        iec_move(result, (iec_t) stack_pop(*list));
-    }
+    if (stack_empty(*list))
+        return IEC_ENL;
 
+    size_t n = stack_size(*list);
+    uint8_t res = iec_move(result, (iec_t) stack_items(*list)[n - 1 - iec_mux_index(v1, n)]);
     stack_flush(*list);
 
-    return IEC_OK;
+    return res;
 }
 
 #endif /* IEC_SELECTION_H_ */
@@ -92,6 +92,7 @@
 
 #include "iec61131lib.h"
 #include "iec_hardware.h"
+#include "iec_scan.h"
 
 /**
  * @fn uint8_t iec_sr(iec_t *q1, iec_t s1, iec_t r)
@@ -109,7 +110,7 @@ uint8_t iec_sr(iec_t *q1, iec_t s1, iec_t r) {
     iec_totype(q1, IEC_T_BOOL);
     iec_set_maintain(*q1);
 
-    iec_set_value(*q1, (iec_get_value(s1) || (iec_get_value((*q1)) && !(iec_get_value(r)))));
+    iec_set_value(*q1, (iec_get_uint(s1) || (iec_get_uint((*q1)) && !(iec_get_uint(r)))));
 
     return IEC_OK;
 }
@@ -130,7 +131,7 @@ uint8_t iec_rs(iec_t *q1, iec_t s, iec_t r1) {
     iec_totype(q1, IEC_T_BOOL);
     iec_set_maintain(*q1);
 
-    iec_set_value(*q1, ((iec_get_value((*q1)) || iec_get_value(s)) && !(iec_get_value(r1))));
+    iec_set_value(*q1, ((iec_get_uint((*q1)) || iec_get_uint(s)) && !(iec_get_uint(r1))));
 
     return IEC_OK;
 }
@@ -149,8 +150,8 @@ uint8_t iec_r_trig(iec_t *q, iec_t clk) {
     iec_totype(q, IEC_T_BOOL);
     iec_set_maintain(*q);
 
-    iec_set_value(*q, (iec_get_value(clk) && !(iec_is_flag1(*q))));
-    if (iec_get_value(clk))
+    iec_set_value(*q, (iec_get_uint(clk) && !(iec_is_flag1(*q))));
+    if (iec_get_uint(clk))
         iec_set_flag1(*q);
     else
         iec_unset_flag1(*q);
@@ -172,8 +173,8 @@ uint8_t iec_f_trig(iec_t *q, iec_t clk) {
     iec_totype(q, IEC_T_BOOL);
     iec_set_maintain(*q);
 
-    iec_set_value(*q, (!iec_get_value(clk) && !(iec_is_flag1(*q))));
-    if (iec_get_value(clk))
+    iec_set_value(*q, (!iec_get_uint(clk) && !(iec_is_flag1(*q))));
+    if (iec_get_uint(clk))
         iec_unset_flag1(*q);
     else
         iec_set_flag1(*q);
@@ -200,12 +201,12 @@ uint8_t iec_ctu(iec_t *q, iec_t cu, iec_t r, iec_t pv, iec_t *cv) {
 
     iec_totype(q, IEC_T_BOOL);
 
-    if (iec_get_value(r)) {
-        iec_set_value(*cv, 0);
-    } else if (iec_get_value(cu) && (iec_get_value(*cv) < iec_get_value(pv)))
-        iec_set_value(*cv, iec_get_value(*cv) + 1);
+    if (iec_get_uint(r)) {
+        iec_set_int(*cv, 0);
+    } else if (iec_get_uint(cu) && (iec_get_int(*cv) < iec_get_int(pv)))
+        iec_set_int(*cv, iec_get_int(*cv) + 1);
 
-    iec_set_value(*q, iec_get_value(*cv) >= iec_get_value(pv))
+    iec_set_value(*q, iec_get_int(*cv) >= iec_get_int(pv));
 
     return IEC_OK;
 }
@@ -229,12 +230,12 @@ uint8_t iec_ctd(iec_t *q, iec_t cd, iec_t ld, iec_t pv, iec_t *cv) {
 
     iec_totype(q, IEC_T_BOOL);
 
-    if (iec_get_value(ld)) {
-        iec_set_value(*cv, iec_get_value(pv));
-    } else if (iec_get_value(cd) && (iec_get_value(*cv) > 0))
-        iec_set_value(*cv, iec_get_value(*cv) - 1);
+    if (iec_get_uint(ld)) {
+        iec_set_int(*cv, iec_get_int(pv));
+    } else if (iec_get_uint(cd) && (iec_get_int(*cv) > 0))
+        iec_set_int(*cv, iec_get_int(*cv) - 1);
 
-    iec_set_value(*q, iec_get_value(*cv) <= 0)
+    iec_set_value(*q, iec_get_int(*cv) <= 0);
 
     return IEC_OK;
 }
@@ -252,7 +253,7 @@ uint8_t iec_initialize_timer(iec_t *timer, iec_t pt) {
     iec_type_allowed(pt, IEC_T_TIME);
 
     iec_timer(*timer)->q = false;
-    iec_timer(*timer)->pt = iec_get_value(pt);
+    iec_timer(*timer)->pt = iec_get_real(pt);
     iec_timer(*timer)->et = 0;
     iec_timer(*timer)->timer_run = false;
     iec_timer(*timer)->t0 = 0;
@@ -262,6 +263,22 @@ uint8_t iec_initialize_timer(iec_t *timer, iec_t pt) {
     return IEC_OK;
 }
 
+/**
+ * @fn static inline uint64_t iec_timer_elapsed(const t_timer_t *t, uint64_t now)
+ * @brief time (ms) from start of timer to now. 32 bits clock wrap is handled
+ *
+ * @param t
+ * @param now
+ * @return ms
+ */
+static inline uint64_t iec_timer_elapsed(const t_timer_t *t, uint64_t now) {
+#ifdef ALLOW_64BITS
+    return now - t->t0;
+#else
+    return (uint32_t) (now - t->t0);
+#endif
+}
+
 /**
  * @fn uint8_t iec_tp(iec_t *timer, iec_t in, iec_t pt, iec_t *et)
  * @brief
@@ -278,29 +295,37 @@ uint8_t iec_tp(iec_t *timer, iec_t in, iec_t pt, iec_t *et) {
     if (!iec_is_initialized(*timer))
         iec_initialize_timer(timer, pt);
 
-    if (iec_get_value(in)) {
-        if (iec_timer(*timer)->t0 == 0) {
-            iec_timer(*timer)->t0 = hw_millis();
-        }
-    }
+    t_timer_t *t = iec_timer(*timer);
+    uint64_t now = iec_scan_millis();
+    bool input = iec_get_uint(in);
+    bool edge = input && !iec_is_flag1(*timer); /* flag1 holds IN of previous call */
 
-    if (iec_timer(*timer)->t0 > 0) {
-        iec_timer(*timer)->et = hw_millis() - iec_timer(*timer)->t0;
-        if (iec_timer(*timer)->et >= iec_timer(*timer)->pt) {
-            iec_timer(*timer)->et = iec_timer(*timer)->pt;
+    if (t->timer_run) {
+        t->et = iec_timer_elapsed(t, now);
+        if (t->et >= t->pt) {
+            t->et = t->pt;
+            t->timer_run = false;
         }
     }
 
-    if (!iec_get_value(in) && iec_timer(*timer)->et == iec_timer(*timer)->pt) {
-        iec_timer(*timer)->t0 = 0;
-        iec_timer(*timer)->et = 0;
+    if (edge && !t->timer_run && t->pt > 0) {
+        t->timer_run = true;
+        t->t0 = now;
+        t->et = 0;
     }
 
-    iec_timer(*timer)->q = iec_timer(*timer)->et > 0 && iec_timer(*timer)->et < iec_timer(*timer)->pt;
+    if (!input && !t->timer_run)
+        t->et = 0;
+
+    t->q = t->timer_run;
+    if (input)
+        iec_set_flag1(*timer);
+    else
+        iec_unset_flag1(*timer);
 
     if (*et != NULL) {
         iec_type_allowed(*et, IEC_T_TIME);
-        iec_set_value(*et, iec_timer(*timer)->et);
+        iec_set_value(*et, t->et);
     }
 
     return IEC_OK;
@@ -322,24 +347,32 @@ uint8_t iec_ton(iec_t *timer, iec_t in, iec_t pt, iec_t *et) {
     if (!iec_is_initialized(*timer))
         iec_initialize_timer(timer, pt);
 
-    if (!iec_get_value(in)) {
-        iec_timer(*timer)->et = 0;
-        iec_timer(*timer)->t0 = 0;
-        iec_timer(*timer)->q = false;
+    t_timer_t *t = iec_timer(*timer);
+    uint64_t now = iec_scan_millis();
+    bool input = iec_get_uint(in);
+
+    if (!input) {
+        t->et = 0;
+        t->timer_run = false;
+        t->q = false;
     } else {
-        if (iec_timer(*timer)->t0 == 0) {
-            iec_timer(*timer)->t0 = hw_millis();
+        if (!t->timer_run && !t->q) {
+            t->timer_run = true;
+            t->t0 = now;
         }
-        iec_timer(*timer)->et = hw_millis() - iec_timer(*timer)->t0;
-        if (iec_timer(*timer)->et >= iec_timer(*timer)->pt) {
-            iec_timer(*timer)->et = iec_timer(*timer)->pt;
-            iec_timer(*timer)->q = true;
+        if (t->timer_run) {
+            t->et = iec_timer_elapsed(t, now);
+            if (t->et >= t->pt) {
+                t->et = t->pt;
+                t->timer_run = false;
+                t->q = true;
+            }
         }
     }
 
     if (*et != NULL) {
         iec_type_allowed(*et, IEC_T_TIME);
-        iec_set_value(*et, iec_timer(*timer)->et);
+        iec_set_value(*et, t->et);
     }
 
     return IEC_OK;
@@ -361,25 +394,32 @@ uint8_t iec_tof(iec_t *timer, iec_t in, iec_t pt, iec_t *et) {
     if (!iec_is_initialized(*timer))
         iec_initialize_timer(timer, pt);
 
-    if (iec_get_value(in)) {
-        iec_timer(*timer)->et = 0;
-        iec_timer(*timer)->t0 = 0;
-        iec_timer(*timer)->q = true;
+    t_timer_t *t = iec_timer(*timer);
+    uint64_t now = iec_scan_millis();
+    bool input = iec_get_uint(in);
+
+    if (input) {
+        t->et = 0;
+        t->timer_run = false;
+        t->q = true;
     } else {
-        if (iec_timer(*timer)->t0 == 0) {
-            iec_timer(*timer)->t0 = hw_millis();
+        if (!t->timer_run && t->q && t->et == 0) {
+            t->timer_run = true;
+            t->t0 = now;
+        }
+        if (t->timer_run) {
+            t->et = iec_timer_elapsed(t, now);
+            if (t->et >= t->pt) {
+                t->et = t->pt;
+                t->timer_run = false;
+                t->q = false;
+            }
         }
-        iec_timer(*timer)->et = hw_millis() - iec_timer(*timer)->t0;
-    }
-
-    if (iec_timer(*timer)->t0 >= iec_timer(*timer)->pt) {
-        iec_timer(*timer)->et = iec_timer(*timer)->pt;
-        iec_timer(*timer)->q = false;
     }
 
     if (*et != NULL) {
         iec_type_allowed(*et, IEC_T_TIME);
-        iec_set_value(*et, iec_timer(*timer)->et);
+        iec_set_value(*et, t->et);
     }
 
     return IEC_OK;
@@ -33,6 +33,9 @@
 
 #include <string.h>
 #include <wchar.h>
+#ifdef IEC_SLICE_CHECK
+#include <assert.h>
+#endif
 
 #include "iec61131lib.h"
 #include "util_buffer_string.h"
@@ -51,7 +54,379 @@
  *  DELETE        1:ANY_STRING;2,3:ANY_INT             3            Delete part of a string.
  *  REPLACE       1:ANY_STRING;2:ANY_CHAR;3,4:ANY_INT  4            Replaces part of one string with another string.
  *  FIND          1:ANY_STRING;2:ANY_CHAR              2            Finds the location of one string within another.
+ *
+ *  Strings own their storage: up to IEC_STRING_SSO characters inline in the value, longer ones in one
+ *  buffer. STRING[n] (iec_string_init) has fixed capacity n allocated once; longer results are truncated
+ *  and return IEC_TRN. Results are written in the storage of result, so LEN/LEFT/RIGHT/MID don't allocate
+ *  when it has enough capacity. Positions are 1 based.
+ *
+ *  Slices (iec_slice_t) are read only views of a string: iec_string_*_slice() and iec_slice_*() take parts
+ *  of strings and slices without copying. A string that changes first gives its live slices an own copy,
+ *  so slices stay valid; iec_slice_materialize() copies a slice into a string to write it. Slices are
+ *  linked to their string: release them with iec_slice_release() and don't copy them by value. A slice
+ *  declared with IEC_SLICE_SCOPE is released at the end of its scope (GCC/Clang); with IEC_SLICE_CHECK
+ *  defined, a slice still linked there fails an assert instead, to find missing releases.
+ *
+ *  Interning (opt-in): iec_string_intern() makes a string share the storage of the equal entry of an
+ *  iec_intern_t table, so repeated strings are stored once and EQ/NE compare them by pointer; iec_move
+ *  of an interned string shares it too. Writing an interned string copies it first. The table must
+ *  outlive the strings that use it.
+ */
+
+/**
+ * @typedef iec_intern_entry_t
+ * @brief interned string. Characters follow the entry
+ *
+ */
+typedef struct iec_intern_entry_t {
+       str_t str;  /**< shared storage */
+    uint32_t hash; /**< hash of characters */
+} iec_intern_entry_t;
+
+/**
+ * @typedef iec_intern_t
+ * @brief interning table (open addressing by hash)
+ *
+ */
+typedef struct iec_intern_t {
+    iec_intern_entry_t **slot;   /**< entries, NULL if empty */
+              uint32_t capacity; /**< number of slots (power of 2) */
+              uint32_t count;    /**< number of entries */
+} iec_intern_t;
+
+/**
+ * @fn static inline string_t* iec_string_result(iec_t *result, iec_t v1)
+ * @brief make result a string of the same type of v1
+ *
+ * @param result
+ * @param v1
+ * @return string of result
+ */
+static inline string_t* iec_string_result(iec_t *result, iec_t v1) {
+    if ((*result)->type != v1->type)
+        iec_totype(result, v1->type);
+
+    string_t *string = (string_t*) ((*result)->value);
+    string->wstring = ((string_t*) (v1->value))->wstring;
+    string->hash = 0;
+
+    return string;
+}
+
+/**
+ * @fn static inline uint8_t iec_string_part(iec_t *result, iec_t v1, int64_t from, int64_t length)
+ * @brief result = length characters of v1 from position from (0 based), clamped to v1
+ *
+ * @param result
+ * @param v1
+ * @param from
+ * @param length
+ * @return status
+ */
+static inline uint8_t iec_string_part(iec_t *result, iec_t v1, int64_t from, int64_t length) {
+    str_t *str = iec_get_string(v1);
+    uint32_t len = stringLength(str);
+
+    if (from > len)
+        from = len;
+    if (length > len - from)
+        length = len - from;
+
+    return iec_string_copy(iec_string_result(result, v1), len > 0 ? stringValue(str) + from : "", (uint32_t) length);
+}
+
+/**
+ * @fn static inline uint32_t iec_string_chars(iec_t v1, const char **chars)
+ * @brief characters of a string or char
+ *
+ * @param v1
+ * @param chars
+ * @return length
+ */
+static inline uint32_t iec_string_chars(iec_t v1, const char **chars) {
+    if (ANY_CHAR(v1->type)) {
+        *chars = &v1->v_char;
+        return 1;
+    }
+
+    str_t *str = iec_get_string(v1);
+    if (str == NULL || stringValue(str) == NULL) {
+        *chars = "";
+        return 0;
+    }
+
+    *chars = stringValue(str);
+    return stringLength(str);
+}
+
+/**
+ * @fn static inline void iec_slice_init(iec_slice_t *slice)
+ * @brief empty slice
+ *
+ * @param slice
+ */
+static inline void iec_slice_init(iec_slice_t *slice) {
+    slice->parent = NULL;
+    slice->value = "";
+    slice->length = 0;
+    slice->owned = NULL;
+    slice->next = NULL;
+}
+
+/**
+ * @fn void iec_slice_release(iec_slice_t *slice)
+ * @brief unlink slice from its string and free its copy. Slice is empty after
+ *
+ * @param slice
+ */
+void iec_slice_release(iec_slice_t *slice) {
+    if (slice->parent != NULL) {
+        iec_slice_t **link = &slice->parent->slices;
+        while (*link != NULL && *link != slice)
+            link = &(*link)->next;
+        if (*link != NULL)
+            *link = slice->next;
+    }
+    iec_free(slice->owned);
+    iec_slice_init(slice);
+}
+
+/**
+ * @def IEC_SLICE_EMPTY
+ * @brief initializer of empty slice
+ *
+ */
+#define IEC_SLICE_EMPTY  { NULL, "", 0, NULL, NULL }
+
+/**
+ * @fn static inline void iec_slice_scope_end(iec_slice_t *slice)
+ * @brief end of scope of IEC_SLICE_SCOPE slice
+ *
+ * @param slice
+ */
+static inline void iec_slice_scope_end(iec_slice_t *slice) {
+#ifdef IEC_SLICE_CHECK
+    assert(slice->parent == NULL && "slice still linked to its string at end of scope");
+#endif
+    iec_slice_release(slice);
+}
+
+/**
+ * @def IEC_SLICE_SCOPE
+ * @brief put after the name of a slice on the stack to release it at end of scope:
+ *        iec_slice_t s IEC_SLICE_SCOPE = IEC_SLICE_EMPTY;
+ *
+ */
+#if defined(__GNUC__)
+#define IEC_SLICE_SCOPE  __attribute__((cleanup(iec_slice_scope_end)))
+#else
+#define IEC_SLICE_SCOPE
+#endif
+
+/**
+ * @fn static inline uint8_t iec_slice_view(iec_slice_t *slice, string_t *parent, const char *value, uint32_t length)
+ * @brief make slice a view of length characters of parent from value. If parent is NULL (part of a detached
+ *        slice) the characters are copied
+ *
+ * @param slice
+ * @param parent
+ * @param value
+ * @param length
+ * @return status
+ */
+static inline uint8_t iec_slice_view(iec_slice_t *slice, string_t *parent, const char *value, uint32_t length) {
+    char *owned = NULL;
+
+    if (parent == NULL && length > 0) {
+        owned = iec_malloc(length);
+        if (owned == NULL)
+            return IEC_ERR;
+        memcpy(owned, value, length);
+    }
+    iec_slice_release(slice);
+
+    slice->value = owned != NULL ? owned : value;
+    slice->length = length;
+    slice->owned = owned;
+    if (parent != NULL) {
+        slice->parent = parent;
+        slice->next = parent->slices;
+        parent->slices = slice;
+    }
+
+    return IEC_OK;
+}
+
+/**
+ * @fn uint8_t iec_slice_string(iec_slice_t *slice, iec_t v1)
+ * @brief slice of all v1
+ *
+ * @param slice
+ * @param v1
+ * @return status
+ */
+uint8_t iec_slice_string(iec_slice_t *slice, iec_t v1) {
+    iec_anytype_allowed(v1, ANY_STRING,,,,,);
+
+    string_t *string = (string_t*) (v1->value);
+    if (string->str == NULL) {
+        iec_slice_release(slice);
+        return IEC_OK;
+    }
+
+    return iec_slice_view(slice, string, stringValue(string->str), stringLength(string->str));
+}
+
+/**
+ * @fn uint8_t iec_slice_mid(iec_slice_t *dst, const iec_slice_t *src, int64_t l, int64_t p)
+ * @brief l characters of src from position p (1 based). dst may be src
+ *
+ * @param dst
+ * @param src
+ * @param l
+ * @param p
+ * @return status
+ */
+uint8_t iec_slice_mid(iec_slice_t *dst, const iec_slice_t *src, int64_t l, int64_t p) {
+    if (l < 0 || p < 1 || p > (int64_t) src->length + 1)
+        return IEC_OOR;
+    if (l > src->length - (p - 1))
+        l = src->length - (p - 1);
+
+    if (dst == src) {
+        dst->value += p - 1;
+        dst->length = l;
+        return IEC_OK;
+    }
+
+    return iec_slice_view(dst, src->parent, src->value + p - 1, (uint32_t) l);
+}
+
+/**
+ * @fn uint8_t iec_slice_left(iec_slice_t *dst, const iec_slice_t *src, int64_t l)
+ * @brief l leftmost characters of src. dst may be src
+ *
+ * @param dst
+ * @param src
+ * @param l
+ * @return status
+ */
+uint8_t iec_slice_left(iec_slice_t *dst, const iec_slice_t *src, int64_t l) {
+    return iec_slice_mid(dst, src, l, 1);
+}
+
+/**
+ * @fn uint8_t iec_slice_right(iec_slice_t *dst, const iec_slice_t *src, int64_t l)
+ * @brief l rightmost characters of src. dst may be src
+ *
+ * @param dst
+ * @param src
+ * @param l
+ * @return status
+ */
+uint8_t iec_slice_right(iec_slice_t *dst, const iec_slice_t *src, int64_t l) {
+    if (l < 0)
+        return IEC_OOR;
+
+    return iec_slice_mid(dst, src, l, l < src->length ? src->length - l + 1 : 1);
+}
+
+/**
+ * @fn int64_t iec_slice_find(const iec_slice_t *src, const char *chars, uint32_t length)
+ * @brief position (1 based) of first chars in src, 0 if not found
+ *
+ * @param src
+ * @param chars
+ * @param length
+ * @return position
+ */
+int64_t iec_slice_find(const iec_slice_t *src, const char *chars, uint32_t length) {
+    if (length == 0 || length > src->length)
+        return 0;
+
+    const char *found = search_forward(src->value, src->length, chars, length);
+
+    return found != NULL ? found - src->value + 1 : 0;
+}
+
+/**
+ * @fn uint8_t iec_slice_materialize(iec_t *result, const iec_slice_t *slice)
+ * @brief copy slice into string result (keeps result STRING[n] capacity)
+ *
+ * @param result
+ * @param slice
+ * @return status
+ */
+uint8_t iec_slice_materialize(iec_t *result, const iec_slice_t *slice) {
+    iectype_t type = slice->parent != NULL && slice->parent->wstring ? IEC_T_WSTRING : IEC_T_STRING;
+
+    if (!ANY_STRING((*result)->type))
+        iec_totype(result, type);
+
+    string_t *string = (string_t*) ((*result)->value);
+    string->hash = 0;
+
+    return iec_string_copy(string, slice->value, slice->length);
+}
+
+/**
+ * @fn uint8_t iec_string_left_slice(iec_slice_t *slice, iec_t v1, iec_t v2)
+ * @brief LEFT without copy
+ *
+ * @param slice
+ * @param v1
+ * @param v2
+ * @return status
  */
+uint8_t iec_string_left_slice(iec_slice_t *slice, iec_t v1, iec_t v2) {
+    iec_anytype_allowed(v2, ANY_INT,,,,,);
+
+    uint8_t status = iec_slice_string(slice, v1);
+    if (status != IEC_OK)
+        return status;
+
+    return iec_slice_left(slice, slice, iec_get_int(v2));
+}
+
+/**
+ * @fn uint8_t iec_string_right_slice(iec_slice_t *slice, iec_t v1, iec_t v2)
+ * @brief RIGHT without copy
+ *
+ * @param slice
+ * @param v1
+ * @param v2
+ * @return status
+ */
+uint8_t iec_string_right_slice(iec_slice_t *slice, iec_t v1, iec_t v2) {
+    iec_anytype_allowed(v2, ANY_INT,,,,,);
+
+    uint8_t status = iec_slice_string(slice, v1);
+    if (status != IEC_OK)
+        return status;
+
+    return iec_slice_right(slice, slice, iec_get_int(v2));
+}
+
+/**
+ * @fn uint8_t iec_string_mid_slice(iec_slice_t *slice, iec_t v1, iec_t v2, iec_t v3)
+ * @brief MID without copy
+ *
+ * @param slice
+ * @param v1
+ * @param v2
+ * @param v3
+ * @return status
+ */
+uint8_t iec_string_mid_slice(iec_slice_t *slice, iec_t v1, iec_t v2, iec_t v3) {
+    iec_anytype_allowed(v2, ANY_INT,,,,,);
+    iec_anytype_allowed(v3, ANY_INT,,,,,);
+
+    uint8_t status = iec_slice_string(slice, v1);
+    if (status != IEC_OK)
+        return status;
+
+    return iec_slice_mid(slice, slice, iec_get_int(v2), iec_get_int(v3));
+}
 
 /**
  * @fn uint8_t iec_string_len(iec_t *result, iec_t v1)
@@ -65,15 +440,14 @@ uint8_t iec_string_len(iec_t *result, iec_t v1) {
     iec_anytype_allowed(v1, ANY_STRING,,,,,);
     iec_totype(result, IEC_T_UDINT);
 
-    str_t *str = iec_get_string(v1);
-    iec_set_value(*result, str->length);
+    iec_set_value(*result, stringLength(iec_get_string(v1)));
 
     return IEC_OK;
 }
 
 /**
  * @fn uint8_t iec_string_left(iec_t *result, iec_t v1, iec_t v2)
- * @brief
+ * @brief v2 leftmost characters of v1
  *
  * @param result
  * @param v1
@@ -83,12 +457,17 @@ uint8_t iec_string_len(iec_t *result, iec_t v1) {
 uint8_t iec_string_left(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_STRING,,,,,);
     iec_anytype_allowed(v2, ANY_INT,,,,,);
-    return IEC_OK;
+
+    int64_t l = iec_get_int(v2);
+    if (l < 0)
+        return IEC_OOR;
+
+    return iec_string_part(result, v1, 0, l);
 }
 
 /**
  * @fn uint8_t iec_string_right(iec_t *result, iec_t v1, iec_t v2)
- * @brief
+ * @brief v2 rightmost characters of v1
  *
  * @param result
  * @param v1
@@ -98,12 +477,18 @@ uint8_t iec_string_left(iec_t *result, iec_t v1, iec_t v2) {
 uint8_t iec_string_right(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_STRING,,,,,);
     iec_anytype_allowed(v2, ANY_INT,,,,,);
-    return IEC_OK;
+
+    int64_t l = iec_get_int(v2);
+    int64_t len = stringLength(iec_get_string(v1));
+    if (l < 0)
+        return IEC_OOR;
+
+    return iec_string_part(result, v1, l < len ? len - l : 0, l);
 }
 
 /**
  * @fn uint8_t iec_string_mid(iec_t *result, iec_t v1, iec_t v2, iec_t v3)
- * @brief
+ * @brief v2 characters of v1 from position v3
  *
  * @param result
  * @param v1
@@ -115,19 +500,116 @@ uint8_t iec_string_mid(iec_t *result, iec_t v1, iec_t v2, iec_t v3) {
     iec_anytype_allowed(v1, ANY_STRING,,,,,);
     iec_anytype_allowed(v2, ANY_INT,,,,,);
     iec_anytype_allowed(v3, ANY_INT,,,,,);
-    return IEC_OK;
+
+    int64_t l = iec_get_int(v2);
+    int64_t p = iec_get_int(v3);
+    if (l < 0 || p < 1 || p > (int64_t) stringLength(iec_get_string(v1)) + 1)
+        return IEC_OOR;
+
+    return iec_string_part(result, v1, p - 1, l);
+}
+
+/**
+ * @fn uint8_t iec_string_concat_n(iec_t *result, iec_t *args, size_t n)
+ * @brief concatenation of n inputs (first ANY_STRING, others ANY_STRING or ANY_CHAR). Length is computed
+ *        first and storage reserved once, so every input is copied once and nothing is reallocated
+ *
+ * @param result
+ * @param args
+ * @param n
+ * @return status (IEC_TRN if truncated to STRING[n] length of result)
+ */
+uint8_t iec_string_concat_n(iec_t *result, iec_t *args, size_t n) {
+    if (*result == NULL || args == NULL)
+        return IEC_NLL;
+    if (n == 0)
+        return IEC_ENL;
+
+    iec_anytype_allowed(args[0], ANY_STRING,,,,,);
+    const char *chars;
+    uint64_t total = 0;
+    bool alias = false;
+    for (size_t i = 0; i < n; i++) {
+        iec_anytype_allowed(args[i], ANY_CHAR, ANY_STRING,,,,);
+        total += iec_string_chars(args[i], &chars);
+        alias |= i > 0 && args[i] == *result;
+    }
+
+    uint8_t status = IEC_OK;
+    uint32_t max = ANY_STRING((*result)->type) ? ((string_t*) ((*result)->value))->max : 0;
+    if (total > UINT32_MAX - 1)
+        total = UINT32_MAX - 1;
+    if (max > 0 && total > max) {
+        total = max;
+        status = IEC_TRN;
+    }
+
+    // CONCAT(s, s, ...): pieces would be overwritten while copied, assemble aside
+    if (alias) {
+        char *buffer = iec_malloc(total + 1);
+        if (buffer == NULL)
+            return IEC_ERR;
+        uint32_t length = 0;
+        for (size_t i = 0; i < n && length < total; i++) {
+            uint32_t len = iec_string_chars(args[i], &chars);
+            if (len > total - length)
+                len = total - length;
+            memcpy(buffer + length, chars, len);
+            length += len;
+        }
+        iec_string_copy(iec_string_result(result, args[0]), buffer, length);
+        iec_free(buffer);
+        return status;
+    }
+
+    // s := CONCAT(s, ...) appends to s
+    string_t *string = iec_string_result(result, args[0]);
+    size_t first = 0;
+    if (args[0] == *result && string->str == &string->buffer) {
+        first = 1;
+    } else {
+        iec_string_detach(string);
+        string->buffer.length = 0;
+    }
+
+    if (iec_string_reserve(string, total) != IEC_OK)
+        return IEC_ERR;
+
+    char *buffer = string->buffer.value;
+    uint32_t length = string->buffer.length;
+    for (size_t i = first; i < n && length < total; i++) {
+        uint32_t len = iec_string_chars(args[i], &chars);
+        if (len > total - length)
+            len = total - length;
+        memcpy(buffer + length, chars, len);
+        length += len;
+    }
+
+    string->buffer.length = length;
+    TERMINATE_STRING(&string->buffer);
+    string->str = &string->buffer;
+    string->len = length;
+    string->interned = false;
+
+    return status;
 }
 
 /**
  * @fn uint8_t iec_string_concat(iec_t *result, stack_t list)
- * @brief
+ * @brief CONCAT of list items (push order). List is flushed
  *
  * @param result
  * @param list
  * @return status
  */
 uint8_t iec_string_concat(iec_t *result, stack_t list) {
-    return IEC_OK;
+    if (*result == NULL || list == NULL)
+        return IEC_NLL;
+
+    uint8_t res = iec_string_concat_n(result, (iec_t*) stack_items(list), stack_size(list));
+    stack_flush(list);
+
+    return res;
 }
 
 /**
@@ -185,7 +667,7 @@ uint8_t iec_string_replace(iec_t *result, iec_t v1, iec_t v2, iec_t v3, iec_t v4
 
 /**
  * @fn uint8_t iec_string_find(iec_t *result, iec_t v1, iec_t v2)
- * @brief
+ * @brief position (1 based) of first v2 (string or CHAR) in v1, 0 if not found
  *
  * @param result
  * @param v1
@@ -194,7 +676,19 @@ uint8_t iec_string_replace(iec_t *result, iec_t v1, iec_t v2, iec_t v3, iec_t v4
  */
 uint8_t iec_string_find(iec_t *result, iec_t v1, iec_t v2) {
     iec_anytype_allowed(v1, ANY_STRING,,,,,);
-    iec_anytype_allowed(v2, ANY_CHAR,,,,,);
+    iec_anytype_allowed(v2, ANY_CHAR, ANY_STRING,,,,);
+
+    iec_slice_t haystack;
+    iec_slice_init(&haystack);
+    iec_slice_string(&haystack, v1);
+    int64_t position = ANY_STRING(v2->type) ?
+            iec_slice_find(&haystack, stringValue(iec_get_string(v2)), stringLength(iec_get_string(v2))) :
+            iec_slice_find(&haystack, &v2->v_char, 1);
+    iec_slice_release(&haystack);
+
+    iec_totype(result, IEC_T_INT);
+    iec_set_value(*result, position);
+
     return IEC_OK;
 }
 
@@ -209,20 +703,188 @@ uint8_t iec_string_find(iec_t *result, iec_t v1, iec_t v2) {
  * @return status
  */
 uint8_t iec_string_set(iec_t *result, char *str, bool wstr, bool hash) {
-    if (wstr) {
-        iec_totype(result, IEC_T_WSTRING);
-    } else {
-        iec_totype(result, IEC_T_STRING);
+    iectype_t type = wstr ? IEC_T_WSTRING : IEC_T_STRING;
+
+    if ((*result)->type != type)
+        iec_totype(result, type);
+
+    string_t *string = (string_t*) ((*result)->value);
+    uint8_t status = iec_string_copy(string, str, strlen(str));
+    if (status == IEC_ERR)
+        return IEC_ERR;
+
+    string->wstring = wstr;
+    string->hash = hash ? PMurHash32(STR_SEED_HASH, stringValue(string->str), stringLength(string->str)) : 0;
+
+    return status;
+}
+
+/**
+ * @fn uint8_t iec_string_init(iec_t *result, uint32_t n, bool wstr)
+ * @brief declare result as empty STRING[n] / WSTRING[n]. Storage is allocated once (n > IEC_STRING_SSO)
+ *        and never changes; n = 0 is not bounded
+ *
+ * @param result
+ * @param n
+ * @param wstr
+ * @return status
+ */
+uint8_t iec_string_init(iec_t *result, uint32_t n, bool wstr) {
+    iectype_t type = wstr ? IEC_T_WSTRING : IEC_T_STRING;
+
+    if ((*result)->type != type)
+        iec_totype(result, type);
+
+    string_t *string = (string_t*) ((*result)->value);
+    iec_string_detach(string);
+    if (string->buffer.value != NULL && string->buffer.value != string->local)
+        iec_free(string->buffer.value);
+    string->buffer.value = NULL;
+    string->max = n;
+    string->wstring = wstr;
+    string->hash = 0;
+
+    if (iec_string_reserve(string, n) != IEC_OK)
+        return IEC_ERR;
+
+    return iec_string_copy(string, "", 0);
+}
+
+/**
+ * @fn uint8_t iec_intern_init(iec_intern_t *table, uint32_t capacity)
+ * @brief empty table for about capacity strings (it grows if needed)
+ *
+ * @param table
+ * @param capacity
+ * @return status
+ */
+uint8_t iec_intern_init(iec_intern_t *table, uint32_t capacity) {
+    uint32_t slots = 16;
+    while (slots < capacity * 2 && slots < 0x80000000)
+        slots <<= 1;
+
+    table->slot = iec_malloc(slots * sizeof(iec_intern_entry_t*));
+    table->capacity = table->slot != NULL ? slots : 0;
+    table->count = 0;
+    if (table->slot == NULL)
+        return IEC_ERR;
+    memset(table->slot, 0, slots * sizeof(iec_intern_entry_t*));
+
+    return IEC_OK;
+}
+
+/**
+ * @fn void iec_intern_release(iec_intern_t *table)
+ * @brief free table and its entries
+ *
+ * @param table
+ */
+void iec_intern_release(iec_intern_t *table) {
+    for (uint32_t n = 0; n < table->capacity; n++)
+        iec_free(table->slot[n]);
+    iec_free(table->slot);
+    table->slot = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+/**
+ * @fn static inline uint8_t iec_intern_grow(iec_intern_t *table)
+ * @brief double slots. Entries don't move, so strings that share them stay valid
+ *
+ * @param table
+ * @return status
+ */
+static inline uint8_t iec_intern_grow(iec_intern_t *table) {
+    uint32_t capacity = table->capacity * 2;
+    iec_intern_entry_t **slot = iec_malloc(capacity * sizeof(iec_intern_entry_t*));
+    if (slot == NULL)
+        return IEC_ERR;
+    memset(slot, 0, capacity * sizeof(iec_intern_entry_t*));
+
+    for (uint32_t n = 0; n < table->capacity; n++) {
+        if (table->slot[n] == NULL)
+            continue;
+        uint32_t i = table->slot[n]->hash & (capacity - 1);
+        while (slot[i] != NULL)
+            i = (i + 1) & (capacity - 1);
+        slot[i] = table->slot[n];
     }
 
-    (*result)->value = malloc(sizeof(string_t));
-    ((string_t*) ((*result)->value))->str = newStringWithLength2(&(str_t) { 0 }, str, strlen(str));
+    iec_free(table->slot);
+    table->slot = slot;
+    table->capacity = capacity;
+
+    return IEC_OK;
+}
 
-    if (hash) {
-        ((string_t*) ((*result)->value))->hash = PMurHash32(STR_SEED_HASH, stringValue(((string_t*) ((*result)->value))->str),
-                stringLength(((string_t*) ((*result)->value))->str));
+/**
+ * @fn iec_intern_entry_t* iec_intern(iec_intern_t *table, const char *chars, uint32_t length)
+ * @brief entry equal to chars, added if not found
+ *
+ * @param table
+ * @param chars
+ * @param length
+ * @return entry (NULL if no memory)
+ */
+iec_intern_entry_t* iec_intern(iec_intern_t *table, const char *chars, uint32_t length) {
+    uint32_t hash = PMurHash32(STR_SEED_HASH, chars, length);
+    uint32_t i = hash & (table->capacity - 1);
+    for (iec_intern_entry_t *entry; (entry = table->slot[i]) != NULL; i = (i + 1) & (table->capacity - 1)) {
+        if (entry->hash == hash && entry->str.length == length && memcmp(entry->str.value, chars, length) == 0)
+            return entry;
+    }
+
+    // grow only to insert, then find the free slot again
+    if (table->count * 2 >= table->capacity) {
+        if (iec_intern_grow(table) != IEC_OK)
+            return NULL;
+        i = hash & (table->capacity - 1);
+        while (table->slot[i] != NULL)
+            i = (i + 1) & (table->capacity - 1);
     }
 
+    iec_intern_entry_t *entry = iec_malloc(sizeof(iec_intern_entry_t) + length + 1);
+    if (entry == NULL)
+        return NULL;
+    entry->str.value = (char*) (entry + 1);
+    entry->str.length = length;
+    entry->str.capacity = length + 1;
+    entry->hash = hash;
+    memcpy(entry->str.value, chars, length);
+    entry->str.value[length] = '\0';
+
+    table->slot[i] = entry;
+    table->count++;
+
+    return entry;
+}
+
+/**
+ * @fn uint8_t iec_string_intern(iec_intern_t *table, iec_t v1)
+ * @brief make v1 share the storage of its entry in table
+ *
+ * @param table
+ * @param v1
+ * @return status
+ */
+uint8_t iec_string_intern(iec_intern_t *table, iec_t v1) {
+    iec_anytype_allowed(v1, ANY_STRING,,,,,);
+    if (table == NULL || table->slot == NULL)
+        return IEC_NLL;
+
+    const char *chars;
+    uint32_t length = iec_string_chars(v1, &chars);
+    iec_intern_entry_t *entry = iec_intern(table, chars, length);
+    if (entry == NULL)
+        return IEC_ERR;
+
+    string_t *string = (string_t*) (v1->value);
+    string->str = &entry->str;
+    string->len = length;
+    string->hash = entry->hash;
+    string->interned = true;
+
     return IEC_OK;
 }
 
@@ -0,0 +1,353 @@
+/**
+ * @file iec_timer_bank.h
+ * @brief Structure of arrays timer bank (TP, TON, TOF) with SIMD update
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_TIMER_BANK_H_
+#define IEC_TIMER_BANK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iec61131lib.h"
+#include "iec_batch.h"
+
+/*
+ * Summary:
+ *
+ *  Function        Parameter Type   Parameters     Description
+ *
+ *  TP, TON, TOF    bank             Instances      count timers of the same kind (IEC_TIMER_BANK_TP/TON/TOF).
+ *                  IN  packed BOOL  Input          bank->in, 64 per word (layout of iec_bool_bank_t).
+ *                  PT  uint32_t     Input          bank->pt[i] (ms).
+ *                  Q   packed BOOL  Output         bank->q.
+ *                  ET  uint32_t     Output         bank->et[i] (ms).
+ *
+ *  iec_timer_bank_update() gives the outputs of iec_tp/iec_ton/iec_tof called for each instance with the
+ *  same time, as long as PT and elapsed times fit 32 bits (49 days). With AVX2 it evaluates 8 instances
+ *  per iteration, without branches.
+ */
+
+/**
+ * @enum IEC_TIMER_BANK_KIND
+ * @brief timer kind
+ *
+ */
+enum IEC_TIMER_BANK_KIND {
+    IEC_TIMER_BANK_TP,  /**< pulse */
+    IEC_TIMER_BANK_TON, /**< on delay */
+    IEC_TIMER_BANK_TOF, /**< off delay */
+};
+
+/**
+ * @typedef iec_timer_bank_t
+ * @brief timers as parallel arrays
+ *
+ */
+typedef struct iec_timer_bank_t {
+    uint32_t *pt;    /**< preset time (ms) */
+    uint32_t *et;    /**< elapsed time (ms) */
+    uint32_t *t0;    /**< start time (ms, modulo 2^32) */
+    uint64_t *in;    /**< input */
+    uint64_t *q;     /**< output */
+    uint64_t *run;   /**< running */
+    uint64_t *prev;  /**< input at previous update */
+    uint32_t count;  /**< number of timers */
+     uint8_t kind;   /**< IEC_TIMER_BANK_KIND */
+} iec_timer_bank_t;
+
+/**
+ * @fn uint8_t iec_timer_bank_init(iec_timer_bank_t *bank, uint8_t kind, uint32_t count)
+ * @brief count timers, IN FALSE and PT 0
+ *
+ * @param bank
+ * @param kind IEC_TIMER_BANK_KIND
+ * @param count
+ * @return status
+ */
+uint8_t iec_timer_bank_init(iec_timer_bank_t *bank, uint8_t kind, uint32_t count) {
+    size_t times = (count > 0 ? count : 1) * sizeof(uint32_t);
+    size_t bits = (count > 0 ? IEC_BATCH_MASK_WORDS(count) : 1) * sizeof(uint64_t);
+
+    memset(bank, 0, sizeof(iec_timer_bank_t));
+    if (kind > IEC_TIMER_BANK_TOF)
+        return IEC_NAT;
+
+    bank->pt = iec_malloc(times);
+    bank->et = iec_malloc(times);
+    bank->t0 = iec_malloc(times);
+    bank->in = iec_malloc(bits);
+    bank->q = iec_malloc(bits);
+    bank->run = iec_malloc(bits);
+    bank->prev = iec_malloc(bits);
+    if (bank->pt == NULL || bank->et == NULL || bank->t0 == NULL || bank->in == NULL || bank->q == NULL || bank->run == NULL
+            || bank->prev == NULL) {
+        iec_free(bank->pt);
+        iec_free(bank->et);
+        iec_free(bank->t0);
+        iec_free(bank->in);
+        iec_free(bank->q);
+        iec_free(bank->run);
+        iec_free(bank->prev);
+        memset(bank, 0, sizeof(iec_timer_bank_t));
+        return IEC_ERR;
+    }
+
+    memset(bank->pt, 0, times);
+    memset(bank->et, 0, times);
+    memset(bank->t0, 0, times);
+    memset(bank->in, 0, bits);
+    memset(bank->q, 0, bits);
+    memset(bank->run, 0, bits);
+    memset(bank->prev, 0, bits);
+    bank->count = count;
+    bank->kind = kind;
+
+    return IEC_OK;
+}
+
+/**
+ * @fn void iec_timer_bank_release(iec_timer_bank_t *bank)
+ * @brief
+ *
+ * @param bank
+ */
+void iec_timer_bank_release(iec_timer_bank_t *bank) {
+    iec_free(bank->pt);
+    iec_free(bank->et);
+    iec_free(bank->t0);
+    iec_free(bank->in);
+    iec_free(bank->q);
+    iec_free(bank->run);
+    iec_free(bank->prev);
+    memset(bank, 0, sizeof(iec_timer_bank_t));
+}
+
+/**
+ * @name bit access
+ * @brief
+ *
+ */
+/**@{*/
+#define IEC_TIMER_BANK_GET(words, i)  (((words)[(i) >> 6] >> ((i) & 63)) & 1)
+#define IEC_TIMER_BANK_PUT(words, i, value)                                                       \
+            (words)[(i) >> 6] = ((words)[(i) >> 6] & ~(UINT64_C(1) << ((i) & 63)))                \
+                              | ((uint64_t) (value) << ((i) & 63))
+/**@}*/
+
+/**
+ * @fn static inline void iec_timer_bank_in(iec_timer_bank_t *bank, uint32_t i, bool in)
+ * @brief
+ *
+ * @param bank
+ * @param i
+ * @param in
+ */
+static inline void iec_timer_bank_in(iec_timer_bank_t *bank, uint32_t i, bool in) {
+    IEC_TIMER_BANK_PUT(bank->in, i, in);
+}
+
+/**
+ * @fn static inline bool iec_timer_bank_q(const iec_timer_bank_t *bank, uint32_t i)
+ * @brief
+ *
+ * @param bank
+ * @param i
+ * @return Q
+ */
+static inline bool iec_timer_bank_q(const iec_timer_bank_t *bank, uint32_t i) {
+    return IEC_TIMER_BANK_GET(bank->q, i);
+}
+
+/**
+ * @fn static void iec_timer_bank_update_scalar(iec_timer_bank_t *bank, uint32_t now, uint32_t from)
+ * @brief update timers from .. count - 1, same steps of iec_tp/iec_ton/iec_tof
+ *
+ * @param bank
+ * @param now
+ * @param from
+ */
+static void iec_timer_bank_update_scalar(iec_timer_bank_t *bank, uint32_t now, uint32_t from) {
+    for (uint32_t i = from; i < bank->count; i++) {
+        bool in = IEC_TIMER_BANK_GET(bank->in, i);
+        bool q = IEC_TIMER_BANK_GET(bank->q, i);
+        bool run = IEC_TIMER_BANK_GET(bank->run, i);
+        uint32_t et = bank->et[i];
+        uint32_t pt = bank->pt[i];
+        bool start;
+
+        switch (bank->kind) {
+            case IEC_TIMER_BANK_TP:
+                start = in && !IEC_TIMER_BANK_GET(bank->prev, i) && pt > 0 && (!run || now - bank->t0[i] >= pt);
+                break;
+            case IEC_TIMER_BANK_TON:
+                start = in && !run && !q;
+                break;
+            default:
+                start = !in && !run && q && et == 0;
+                break;
+        }
+        if (start)
+            bank->t0[i] = now;
+        run = run || start;
+
+        if (run) {
+            et = now - bank->t0[i];
+            if (et >= pt) {
+                et = pt;
+                run = false;
+                q = bank->kind == IEC_TIMER_BANK_TON;
+            }
+        }
+
+        switch (bank->kind) {
+            case IEC_TIMER_BANK_TP:
+                if (!in && !run)
+                    et = 0;
+                q = run;
+                break;
+            case IEC_TIMER_BANK_TON:
+                if (!in)
+                    et = 0, run = q = false;
+                break;
+            default:
+                if (in)
+                    et = 0, run = false, q = true;
+                break;
+        }
+
+        bank->et[i] = et;
+        IEC_TIMER_BANK_PUT(bank->q, i, q);
+        IEC_TIMER_BANK_PUT(bank->run, i, run);
+        IEC_TIMER_BANK_PUT(bank->prev, i, in);
+    }
+}
+
+#ifdef IEC_BATCH_X86
+/**
+ * @fn static IEC_BATCH_TARGET_avx2 uint32_t iec_timer_bank_update_avx2(iec_timer_bank_t *bank, uint32_t now)
+ * @brief update groups of 8 timers: flags are expanded from one byte to lane masks and packed back with movemask
+ *
+ * @param bank
+ * @param now
+ * @return number of updated timers
+ */
+static IEC_BATCH_TARGET_avx2 uint32_t iec_timer_bank_update_avx2(iec_timer_bank_t *bank, uint32_t now) {
+    const __m256i lane = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vnow = _mm256_set1_epi32((int32_t) now);
+    uint8_t *in8 = (uint8_t*) bank->in, *q8 = (uint8_t*) bank->q, *run8 = (uint8_t*) bank->run, *prev8 = (uint8_t*) bank->prev;
+    uint32_t i = 0;
+
+#define IEC_TIMER_BANK_LANES(byte)  _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(byte), lane), lane)
+#define IEC_TIMER_BANK_BYTE(mask)   ((uint8_t) _mm256_movemask_ps(_mm256_castsi256_ps(mask)))
+#define IEC_TIMER_BANK_GE(a, b)     _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a)
+
+    for (; i + 8 <= bank->count; i += 8) {
+        __m256i in = IEC_TIMER_BANK_LANES(in8[i >> 3]);
+        __m256i q = IEC_TIMER_BANK_LANES(q8[i >> 3]);
+        __m256i run = IEC_TIMER_BANK_LANES(run8[i >> 3]);
+        __m256i et = _mm256_loadu_si256((const __m256i*) (bank->et + i));
+        __m256i pt = _mm256_loadu_si256((const __m256i*) (bank->pt + i));
+        __m256i t0 = _mm256_loadu_si256((const __m256i*) (bank->t0 + i));
+        __m256i et_zero = _mm256_cmpeq_epi32(et, zero);
+        __m256i start;
+
+        switch (bank->kind) {
+            case IEC_TIMER_BANK_TP:
+                start = _mm256_andnot_si256(IEC_TIMER_BANK_LANES(prev8[i >> 3]), in);
+                start = _mm256_andnot_si256(_mm256_cmpeq_epi32(pt, zero), start);
+                start = _mm256_and_si256(start, _mm256_or_si256(_mm256_cmpeq_epi32(run, zero),
+                                                                IEC_TIMER_BANK_GE(_mm256_sub_epi32(vnow, t0), pt)));
+                break;
+            case IEC_TIMER_BANK_TON:
+                start = _mm256_andnot_si256(_mm256_or_si256(run, q), in);
+                break;
+            default:
+                start = _mm256_andnot_si256(_mm256_or_si256(run, in), _mm256_and_si256(q, et_zero));
+                break;
+        }
+        t0 = _mm256_blendv_epi8(t0, vnow, start);
+        run = _mm256_or_si256(run, start);
+
+        __m256i elapsed = _mm256_sub_epi32(vnow, t0);
+        __m256i expire = _mm256_and_si256(run, IEC_TIMER_BANK_GE(elapsed, pt));
+        et = _mm256_blendv_epi8(et, _mm256_blendv_epi8(elapsed, pt, expire), run);
+        run = _mm256_andnot_si256(expire, run);
+
+        switch (bank->kind) {
+            case IEC_TIMER_BANK_TP:
+                et = _mm256_andnot_si256(_mm256_andnot_si256(in, _mm256_cmpeq_epi32(run, zero)), et);
+                q = run;
+                break;
+            case IEC_TIMER_BANK_TON:
+                q = _mm256_and_si256(_mm256_or_si256(q, expire), in);
+                et = _mm256_and_si256(et, in);
+                run = _mm256_and_si256(run, in);
+                break;
+            default:
+                q = _mm256_or_si256(_mm256_andnot_si256(expire, q), in);
+                et = _mm256_andnot_si256(in, et);
+                run = _mm256_andnot_si256(in, run);
+                break;
+        }
+
+        _mm256_storeu_si256((__m256i*) (bank->et + i), et);
+        _mm256_storeu_si256((__m256i*) (bank->t0 + i), t0);
+        q8[i >> 3] = IEC_TIMER_BANK_BYTE(q);
+        run8[i >> 3] = IEC_TIMER_BANK_BYTE(run);
+        prev8[i >> 3] = in8[i >> 3];
+    }
+
+#undef IEC_TIMER_BANK_LANES
+#undef IEC_TIMER_BANK_BYTE
+#undef IEC_TIMER_BANK_GE
+
+    return i;
+}
+#endif
+
+/**
+ * @fn void iec_timer_bank_update(iec_timer_bank_t *bank, uint64_t now)
+ * @brief evaluate all timers at time now (ms)
+ *
+ * @param bank
+ * @param now
+ */
+void iec_timer_bank_update(iec_timer_bank_t *bank, uint64_t now) {
+    uint32_t done = 0;
+
+#ifdef IEC_BATCH_X86
+    if (iec_batch_level() >= IEC_BATCH_AVX2)
+        done = iec_timer_bank_update_avx2(bank, (uint32_t) now);
+#endif
+    iec_timer_bank_update_scalar(bank, (uint32_t) now, done);
+}
+
+#endif /* IEC_TIMER_BANK_H_ */
@@ -0,0 +1,480 @@
+/**
+ * @file iec_timer_wheel.h
+ * @brief Timer service (TON, TOF, TP) on a hierarchical timing wheel
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef IEC_TIMER_WHEEL_H_
+#define IEC_TIMER_WHEEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "iec61131lib.h"
+
+/*
+ * Summary:
+ *
+ *  Function        Parameter Type   Parameters     Description
+ *
+ *  TP, TON, TOF    id  uint32_t     Instance       Timer of the service (IEC_WHEEL_TP/TON/TOF).
+ *                  IN  bool         Input          iec_wheel_in(): only an edge does work.
+ *                  PT  TIME         Input          Preset time (ms), used from next start.
+ *                  Q   BOOL         Output         iec_wheel_q().
+ *                  ET  TIME         Output         iec_wheel_et(), computed on read.
+ *
+ *  Timers are kept on a hierarchical wheel of IEC_WHEEL_LEVELS levels of 64 slots (tick 1 ms):
+ *  level l holds timers expiring within 64^(l+1) ms and is cascaded to the level below each 64^l ms.
+ *  A bitmap of non empty slots per level lets iec_wheel_advance() jump over empty slots, so a scan
+ *  only touches timers that start, stop or expire. Longer timers wait in the last level and are
+ *  placed again when it cascades.
+ *
+ *  Each scan: iec_wheel_advance(wheel, iec_scan_millis()), then iec_wheel_in() and reads of Q/ET.
+ */
+
+#define IEC_WHEEL_LEVELS  4                  /**< wheel levels */
+#define IEC_WHEEL_BITS    6                  /**< log2 slots per level */
+#define IEC_WHEEL_SLOTS   (1 << IEC_WHEEL_BITS)
+#define IEC_WHEEL_MASK    (IEC_WHEEL_SLOTS - 1)
+#define IEC_WHEEL_NONE    UINT32_MAX         /**< end of slot list */
+
+/**
+ * @enum IEC_WHEEL_KIND
+ * @brief timer kind
+ *
+ */
+enum IEC_WHEEL_KIND {
+    IEC_WHEEL_TP,  /**< pulse */
+    IEC_WHEEL_TON, /**< on delay */
+    IEC_WHEEL_TOF, /**< off delay */
+};
+
+/**
+ * @typedef iec_wheel_timer_t
+ * @brief timer of service
+ *
+ */
+typedef struct iec_wheel_timer_t {
+    uint64_t t0;     /**< start time */
+    uint64_t expire; /**< expire time */
+      time_t pt;     /**< preset time */
+    uint32_t next;   /**< next in slot */
+    uint32_t prev;   /**< previous in slot */
+     uint8_t kind;   /**< IEC_WHEEL_KIND */
+     uint8_t level;  /**< level of slot */
+     uint8_t slot;   /**< slot in level */
+        bool in;     /**< input */
+        bool q;      /**< output */
+        bool run;    /**< on wheel */
+        bool done;   /**< expired, ET = PT */
+} iec_wheel_timer_t;
+
+/**
+ * @typedef iec_wheel_t
+ * @brief timer service
+ *
+ */
+typedef struct iec_wheel_t {
+    iec_wheel_timer_t *timers;                               /**< timers */
+             uint32_t count;                                 /**< timers in use */
+             uint32_t capacity;                              /**< allocated timers */
+             uint32_t running;                               /**< timers on wheel */
+             uint64_t now;                                   /**< time of last advance */
+             uint64_t tick;                                  /**< next tick to process */
+             uint64_t occupied[IEC_WHEEL_LEVELS];            /**< non empty slots */
+             uint32_t slot[IEC_WHEEL_LEVELS][IEC_WHEEL_SLOTS]; /**< first timer of slot */
+} iec_wheel_t;
+
+/**
+ * @fn static inline void iec_wheel_link(iec_wheel_t *wheel, uint32_t id)
+ * @brief put timer in slot of its expire time
+ *
+ * @param wheel
+ * @param id
+ */
+static inline void iec_wheel_link(iec_wheel_t *wheel, uint32_t id) {
+    iec_wheel_timer_t *t = &wheel->timers[id];
+    uint64_t expire = t->expire < wheel->tick ? wheel->tick : t->expire;
+    uint64_t delta = expire - wheel->tick;
+    uint8_t level = 0;
+
+    while (level < IEC_WHEEL_LEVELS - 1 && delta >= (UINT64_C(1) << (IEC_WHEEL_BITS * (level + 1))))
+        level++;
+    if (delta >= (UINT64_C(1) << (IEC_WHEEL_BITS * IEC_WHEEL_LEVELS)))
+        expire = wheel->tick + (UINT64_C(1) << (IEC_WHEEL_BITS * IEC_WHEEL_LEVELS)) - 1;
+
+    uint32_t s = (expire >> (IEC_WHEEL_BITS * level)) & IEC_WHEEL_MASK;
+    t->level = level;
+    t->slot = s;
+    t->prev = IEC_WHEEL_NONE;
+    t->next = wheel->slot[level][s];
+    if (t->next != IEC_WHEEL_NONE)
+        wheel->timers[t->next].prev = id;
+    wheel->slot[level][s] = id;
+    wheel->occupied[level] |= UINT64_C(1) << s;
+}
+
+/**
+ * @fn static inline void iec_wheel_unlink(iec_wheel_t *wheel, uint32_t id)
+ * @brief remove timer from its slot
+ *
+ * @param wheel
+ * @param id
+ */
+static inline void iec_wheel_unlink(iec_wheel_t *wheel, uint32_t id) {
+    iec_wheel_timer_t *t = &wheel->timers[id];
+
+    if (t->next != IEC_WHEEL_NONE)
+        wheel->timers[t->next].prev = t->prev;
+    if (t->prev != IEC_WHEEL_NONE) {
+        wheel->timers[t->prev].next = t->next;
+        return;
+    }
+
+    wheel->slot[t->level][t->slot] = t->next;
+    if (t->next == IEC_WHEEL_NONE)
+        wheel->occupied[t->level] &= ~(UINT64_C(1) << t->slot);
+}
+
+/**
+ * @fn static inline void iec_wheel_schedule(iec_wheel_t *wheel, uint32_t id)
+ * @brief start timer: expire at now + PT
+ *
+ * @param wheel
+ * @param id
+ */
+static inline void iec_wheel_schedule(iec_wheel_t *wheel, uint32_t id) {
+    iec_wheel_timer_t *t = &wheel->timers[id];
+
+    t->t0 = wheel->now;
+    t->expire = wheel->now + (uint64_t) t->pt;
+    t->run = true;
+    t->done = false;
+    wheel->running++;
+    iec_wheel_link(wheel, id);
+}
+
+/**
+ * @fn static inline void iec_wheel_cancel(iec_wheel_t *wheel, uint32_t id)
+ * @brief
+ *
+ * @param wheel
+ * @param id
+ */
+static inline void iec_wheel_cancel(iec_wheel_t *wheel, uint32_t id) {
+    if (!wheel->timers[id].run)
+        return;
+
+    iec_wheel_unlink(wheel, id);
+    wheel->timers[id].run = false;
+    wheel->running--;
+}
+
+/**
+ * @fn static inline void iec_wheel_expire(iec_wheel_t *wheel, uint32_t id)
+ * @brief timer reached PT
+ *
+ * @param wheel
+ * @param id
+ */
+static inline void iec_wheel_expire(iec_wheel_t *wheel, uint32_t id) {
+    iec_wheel_timer_t *t = &wheel->timers[id];
+
+    t->run = false;
+    t->done = true;
+    wheel->running--;
+    switch (t->kind) {
+        case IEC_WHEEL_TP:
+            t->q = false;
+            t->done = t->in;
+            break;
+        case IEC_WHEEL_TON:
+            t->q = true;
+            break;
+        case IEC_WHEEL_TOF:
+            t->q = false;
+            break;
+    }
+}
+
+/**
+ * @fn uint8_t iec_wheel_init(iec_wheel_t *wheel, uint32_t capacity, uint64_t now)
+ * @brief
+ *
+ * @param wheel
+ * @param capacity max timers
+ * @param now current time (ms)
+ * @return status
+ */
+uint8_t iec_wheel_init(iec_wheel_t *wheel, uint32_t capacity, uint64_t now) {
+    memset(wheel, 0, sizeof(iec_wheel_t));
+    memset(wheel->slot, 0xff, sizeof(wheel->slot));
+    wheel->timers = iec_malloc((capacity > 0 ? capacity : 1) * sizeof(iec_wheel_timer_t));
+    if (wheel->timers == NULL)
+        return IEC_ERR;
+    wheel->capacity = capacity;
+    wheel->now = now;
+    wheel->tick = now + 1;
+
+    return IEC_OK;
+}
+
+/**
+ * @fn void iec_wheel_release(iec_wheel_t *wheel)
+ * @brief
+ *
+ * @param wheel
+ */
+void iec_wheel_release(iec_wheel_t *wheel) {
+    iec_free(wheel->timers);
+    wheel->timers = NULL;
+    wheel->count = wheel->capacity = wheel->running = 0;
+}
+
+/**
+ * @fn uint8_t iec_wheel_add(iec_wheel_t *wheel, uint8_t kind, time_t pt, uint32_t *id)
+ * @brief new timer, IN FALSE
+ *
+ * @param wheel
+ * @param kind IEC_WHEEL_KIND
+ * @param pt preset time (ms)
+ * @param id
+ * @return status
+ */
+uint8_t iec_wheel_add(iec_wheel_t *wheel, uint8_t kind, time_t pt, uint32_t *id) {
+    if (kind > IEC_WHEEL_TOF || pt < 0)
+        return IEC_NAT;
+    if (wheel->count >= wheel->capacity)
+        return IEC_OOR;
+
+    *id = wheel->count++;
+    memset(&wheel->timers[*id], 0, sizeof(iec_wheel_timer_t));
+    wheel->timers[*id].kind = kind;
+    wheel->timers[*id].pt = pt;
+
+    return IEC_OK;
+}
+
+/**
+ * @fn static inline void iec_wheel_pt(iec_wheel_t *wheel, uint32_t id, time_t pt)
+ * @brief set PT, used from next start
+ *
+ * @param wheel
+ * @param id
+ * @param pt
+ */
+static inline void iec_wheel_pt(iec_wheel_t *wheel, uint32_t id, time_t pt) {
+    wheel->timers[id].pt = pt < 0 ? 0 : pt;
+}
+
+/**
+ * @fn void iec_wheel_in(iec_wheel_t *wheel, uint32_t id, bool in)
+ * @brief set IN of timer at time of last advance
+ *
+ * @param wheel
+ * @param id
+ * @param in
+ */
+void iec_wheel_in(iec_wheel_t *wheel, uint32_t id, bool in) {
+    iec_wheel_timer_t *t = &wheel->timers[id];
+
+    if (t->in == in)
+        return;
+    t->in = in;
+
+    switch (t->kind) {
+        case IEC_WHEEL_TP:
+            if (!in) {
+                if (!t->run)
+                    t->done = false;
+            } else if (!t->run && t->pt > 0) {
+                t->q = true;
+                iec_wheel_schedule(wheel, id);
+            }
+            break;
+
+        case IEC_WHEEL_TON:
+            iec_wheel_cancel(wheel, id);
+            t->q = false;
+            t->done = false;
+            if (in) {
+                if (t->pt > 0)
+                    iec_wheel_schedule(wheel, id);
+                else
+                    t->q = t->done = true;
+            }
+            break;
+
+        case IEC_WHEEL_TOF:
+            iec_wheel_cancel(wheel, id);
+            t->done = false;
+            if (in)
+                t->q = true;
+            else if (t->pt > 0)
+                iec_wheel_schedule(wheel, id);
+            else
+                t->q = false, t->done = true;
+            break;
+    }
+}
+
+/**
+ * @fn static inline void iec_wheel_cascade(iec_wheel_t *wheel)
+ * @brief move timers of upper levels due in next 64^l ticks to lower levels
+ *
+ * @param wheel
+ */
+static inline void iec_wheel_cascade(iec_wheel_t *wheel) {
+    for (uint8_t level = 1; level < IEC_WHEEL_LEVELS; level++) {
+        uint32_t s = (wheel->tick >> (IEC_WHEEL_BITS * level)) & IEC_WHEEL_MASK;
+        uint32_t id = wheel->slot[level][s];
+
+        wheel->slot[level][s] = IEC_WHEEL_NONE;
+        wheel->occupied[level] &= ~(UINT64_C(1) << s);
+        while (id != IEC_WHEEL_NONE) {
+            uint32_t next = wheel->timers[id].next;
+            iec_wheel_link(wheel, id);
+            id = next;
+        }
+
+        if (s != 0)
+            break;
+    }
+}
+
+/**
+ * @fn uint32_t iec_wheel_advance(iec_wheel_t *wheel, uint64_t now)
+ * @brief move time to now, expire timers due
+ *
+ * @param wheel
+ * @param now current time (ms)
+ * @return number of expired timers
+ */
+uint32_t iec_wheel_advance(iec_wheel_t *wheel, uint64_t now) {
+    uint32_t expired = 0;
+
+    if (now <= wheel->now)
+        return 0;
+    wheel->now = now;
+
+    while (wheel->tick <= now) {
+        if (wheel->running == 0) {
+            wheel->tick = now + 1;
+            break;
+        }
+
+        uint32_t s = wheel->tick & IEC_WHEEL_MASK;
+        if (s == 0)
+            iec_wheel_cascade(wheel);
+
+        uint64_t pending = wheel->occupied[0] >> s;
+        if (pending == 0) {
+            uint64_t next = (wheel->tick | IEC_WHEEL_MASK) + 1;
+            wheel->tick = next <= now ? next : now + 1;
+            continue;
+        }
+
+        wheel->tick += __builtin_ctzll(pending);
+        if (wheel->tick > now) {
+            wheel->tick = now + 1;
+            break;
+        }
+
+        s = wheel->tick & IEC_WHEEL_MASK;
+        uint32_t id = wheel->slot[0][s];
+        wheel->slot[0][s] = IEC_WHEEL_NONE;
+        wheel->occupied[0] &= ~(UINT64_C(1) << s);
+        while (id != IEC_WHEEL_NONE) {
+            uint32_t next = wheel->timers[id].next;
+            iec_wheel_expire(wheel, id);
+            expired++;
+            id = next;
+        }
+        wheel->tick++;
+    }
+
+    return expired;
+}
+
+/**
+ * @fn static inline bool iec_wheel_q(const iec_wheel_t *wheel, uint32_t id)
+ * @brief
+ *
+ * @param wheel
+ * @param id
+ * @return Q
+ */
+static inline bool iec_wheel_q(const iec_wheel_t *wheel, uint32_t id) {
+    return wheel->timers[id].q;
+}
+
+/**
+ * @fn static inline time_t iec_wheel_et(const iec_wheel_t *wheel, uint32_t id)
+ * @brief
+ *
+ * @param wheel
+ * @param id
+ * @return ET (ms)
+ */
+static inline time_t iec_wheel_et(const iec_wheel_t *wheel, uint32_t id) {
+    const iec_wheel_timer_t *t = &wheel->timers[id];
+
+    if (t->run)
+        return (time_t) (wheel->now - t->t0);
+
+    return t->done ? t->pt : 0;
+}
+
+/**
+ * @fn uint8_t iec_wheel_get(const iec_wheel_t *wheel, uint32_t id, iec_t *q, iec_t *et)
+ * @brief copy Q and ET of timer to BOOL and TIME variables (NULL to skip)
+ *
+ * @param wheel
+ * @param id
+ * @param q
+ * @param et
+ * @return status
+ */
+uint8_t iec_wheel_get(const iec_wheel_t *wheel, uint32_t id, iec_t *q, iec_t *et) {
+    if (id >= wheel->count)
+        return IEC_ENL;
+
+    if (q != NULL && *q != NULL) {
+        iec_type_allowed(*q, IEC_T_BOOL);
+        iec_set_value(*q, iec_wheel_q(wheel, id));
+    }
+    if (et != NULL && *et != NULL) {
+        iec_type_allowed(*et, IEC_T_TIME);
+        iec_set_value(*et, iec_wheel_et(wheel, id));
+    }
+
+    return IEC_OK;
+}
+
+#endif /* IEC_TIMER_WHEEL_H_ */
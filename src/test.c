@@ -33,6 +33,8 @@
 #include <assert.h>
 #include <inttypes.h>
 
+#define ARENA_POISON 0xa5
+
 #include "iec61131lib.h"
 #include "iec_arithmetic.h"
 #include "iec_bit_shift.h"
@@ -45,8 +47,21 @@
 #include "iec_string.h"
 #include "iec_literals.h"
 #include "iec_std_fun_blocks.h"
+#include "iec_fastpath.h"
+#include "iec_image.h"
+#include "iec_batch.h"
+#include "iec_bool_bank.h"
+#include "iec_edge.h"
+#include "iec_timer_wheel.h"
+#include "iec_scan.h"
+#include "iec_timer_bank.h"
+#include "util_arena.h"
+#include "util_pool.h"
+#include "util_search.h"
 
 int main(void) {
+    hw_clock_init();
+
     uint8_t res = 0;
     iec_t result = IEC_ALLOC;
     iec_t rst_tmp = IEC_ALLOC;
@@ -78,11 +93,21 @@ int main(void) {
 
     res = iec_rol(&result, v1, v2);
     assert(res == IEC_OK);
-    assert(iec_get_value(result) == 977);
+    assert(iec_get_value(result) == 4000);
 
     res = iec_ror(&result, v1, v2);
     assert(res == IEC_OK);
-    assert(iec_get_value(result) == 500);
+    assert(iec_get_value(result) == 250);
+
+    // 64 bits operands keep every bit
+    iec_t sh64 = IEC_ALLOC;
+    iec_init(&sh64, IEC_T_LWORD);
+    iec_set_uint(sh64, 0x1234567890ABCDEFULL);
+    assert(iec_shl(&result, sh64, v2) == IEC_OK && iec_get_uint(result) == 0x48D159E242AF37BCULL);
+    assert(iec_shr(&result, sh64, v2) == IEC_OK && iec_get_uint(result) == 0x048D159E242AF37BULL);
+    assert(iec_rol(&result, sh64, v2) == IEC_OK && iec_get_uint(result) == 0x48D159E242AF37BCULL);
+    assert(iec_ror(&result, sh64, v2) == IEC_OK && iec_get_uint(result) == 0xC48D159E242AF37BULL);
+    iec_deinit(&sh64);
 
     printf("< OK >\n\n");
     /////////////////////////////////////
@@ -93,9 +118,11 @@ int main(void) {
     iec_set_value(v2, 2);
     iec_set_value(result, 0);
 
+    iec_t result_ptr = result;
     res = iec_move(&result, v1);
     assert(res == IEC_OK);
     assert(iec_get_value(result) == 1000);
+    assert(result == result_ptr);
 
     iec_totype(&v1, IEC_T_BOOL);
     iec_set_value(v1, 0);
@@ -108,6 +135,10 @@ int main(void) {
     res = iec_sel(&result, v1, v2, v3);
     assert(res == IEC_OK);
     assert(iec_get_value(result) == 200);
+    iec_t selected = NULL;
+    res = iec_sel_ref(&selected, v1, v2, v3);
+    assert(res == IEC_OK);
+    assert(selected == v3);
 
     iec_totype(&v1, IEC_T_INT);
     iec_set_value(v1, 7);
@@ -126,7 +157,7 @@ int main(void) {
     stack_push(fstk, (void*) v1);
     stack_push(fstk, (void*) v2);
     stack_push(fstk, (void*) v3);
-    res = iec_max(&result, &fstk);
+    res = iec_min(&result, &fstk);
     assert(res == IEC_OK);
     assert(iec_get_value(result) == 7);
     assert(stack_empty(fstk) == 1);
@@ -135,6 +166,19 @@ int main(void) {
     assert(res == IEC_OK);
     assert(iec_get_value(result) == 200);
 
+    res = iec_limit_ref(&selected, v2, v1, v3);
+    assert(res == IEC_OK);
+    assert(selected == v3);
+
+    iec_t sargs[3] = { v1, v2, v3 };
+    size_t index = 0;
+    res = iec_max_index(&index, sargs, 3);
+    assert(res == IEC_OK);
+    assert(index == 1);
+    res = iec_min_index(&index, sargs, 3);
+    assert(res == IEC_OK);
+    assert(index == 0);
+
     stack_push(fstk, (void*) v1);
     stack_push(fstk, (void*) v2);
     stack_push(fstk, (void*) v3);
@@ -150,9 +194,33 @@ int main(void) {
     iec_set_value(v4, -5);
     res = iec_mux(&result, v4, &fstk);
     assert(res == IEC_OK);
-    assert(iec_get_value(result) == 7);
+    assert(iec_get_value(result) == 200);
     assert(stack_empty(fstk) == 1);
 
+    // mixed and 64 bits operands compare exactly, not through double
+    iec_t c64a = IEC_ALLOC, c64b = IEC_ALLOC, c64c = IEC_ALLOC;
+    iec_init(&c64a, IEC_T_LINT);
+    iec_init(&c64b, IEC_T_ULINT);
+    iec_init(&c64c, IEC_T_LINT);
+    iec_set_int(c64a, (int64_t) 1 << 60);
+    iec_set_uint(c64b, ((uint64_t) 1 << 60) + 1);
+    iec_set_int(c64c, ((int64_t) 1 << 60) + 1);
+    assert(iec_eq(&result, c64a, c64b) == IEC_OK && !result->v_bool);
+    assert(iec_lt(&result, c64a, c64b) == IEC_OK && result->v_bool);
+    assert(iec_ne(&result, c64a, c64c) == IEC_OK && result->v_bool);
+    iec_t c64args[2] = { c64a, c64c };
+    assert(iec_max_index(&index, c64args, 2) == IEC_OK && index == 1);
+    assert(iec_min_index(&index, c64args, 2) == IEC_OK && index == 0);
+    assert(iec_limit_ref(&selected, c64c, c64a, c64a) == IEC_OK && selected == c64a);
+    iec_set_int(c64a, -1);
+    iec_set_uint(c64b, UINT64_MAX);
+    assert(iec_eq(&result, c64a, c64b) == IEC_OK && !result->v_bool);
+    assert(iec_lt(&result, c64a, c64b) == IEC_OK && result->v_bool);
+    assert(iec_gt(&result, c64b, c64a) == IEC_OK && result->v_bool);
+    iec_deinit(&c64a);
+    iec_deinit(&c64b);
+    iec_deinit(&c64c);
+
     printf("< OK >\n\n");
     /////////////////////////////////////
 
@@ -175,6 +243,7 @@ int main(void) {
     iec_set_value(v1, 7);
     iec_set_value(v2, 500);
     iec_set_value(v3, 200);
+    iec_totype(&v4, IEC_T_DINT);
     iec_set_value(v4, 100);
     stack_push(fstk, (void*) v1);
     stack_push(fstk, (void*) v2);
@@ -209,10 +278,65 @@ int main(void) {
     assert(res == IEC_OK);
     assert(iec_get_value(result) == 100);
 
-    iec_set_value(v2, 2)
+    iec_set_value(v2, 2);
     res = iec_mod(&result, v1, v2);
     assert(res == IEC_OK);
-    assert(iec_get_value(result) == 49);
+    assert(iec_get_value(result) == 1);
+
+    iec_t args[8] = { v1, v2, v3, v4, v1, v2, v3, v4 };
+    for (int n = 0; n < 8; n++)
+        stack_push(fstk, (void*) args[n]);
+    uint32_t allocs = iec_heap_allocations();
+    res = iec_add(&result, &fstk);
+    assert(res == IEC_OK);
+    assert(iec_get_value(result) == 2 * (7 + 2 + 200 + 100));
+    assert(result->type == IEC_T_DINT);
+    assert(iec_heap_allocations() == allocs);
+
+    res = iec_max_n(&result, args, 8);
+    assert(res == IEC_OK);
+    assert(iec_get_value(result) == 200);
+
+    res = iec_mux_n(&result, v2, args, 8);
+    assert(res == IEC_OK);
+    assert(iec_get_value(result) == 200);
+    iec_set_value(v2, 64);
+    res = iec_mux_ref(&selected, v2, args, 8);
+    assert(res == IEC_OK);
+    assert(selected == v4);
+    iec_set_value(v2, 2);
+    assert(iec_add_n(&result, args, 0) == IEC_ENL);
+
+    iec_t l1 = IEC_ALLOC;
+    iec_t l2 = IEC_ALLOC;
+    iec_init(&l1, IEC_T_LINT);
+    iec_init(&l2, IEC_T_LINT);
+    iec_set_value(l1, INT64_C(9007199254740993));
+    iec_set_value(l2, INT64_C(2));
+    iec_t largs[2] = { l1, l2 };
+    res = iec_add_n(&result, largs, 2);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_LINT && iec_get_int(result) == INT64_C(9007199254740995));
+    res = iec_sub(&result, l1, l2);
+    assert(res == IEC_OK);
+    assert(iec_get_int(result) == INT64_C(9007199254740991));
+    res = iec_div(&result, l1, l2);
+    assert(res == IEC_OK);
+    assert(iec_get_int(result) == INT64_C(4503599627370496));
+    iec_set_value(l2, INT64_MIN);
+    iec_set_value(l1, -1);
+    res = iec_div(&result, l2, l1);
+    assert(res == IEC_OK);
+    assert(iec_get_int(result) == INT64_MIN);
+    iec_totype(&l1, IEC_T_ULINT);
+    iec_totype(&l2, IEC_T_ULINT);
+    iec_set_value(l1, UINT64_MAX);
+    iec_set_value(l2, UINT64_C(10));
+    res = iec_mod(&result, l1, l2);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_ULINT && iec_get_uint(result) == UINT64_MAX % 10);
+    iec_deinit(&l1);
+    iec_deinit(&l2);
 
     printf("< OK >\n\n");
     /////////////////////////////////////
@@ -311,6 +435,1013 @@ int main(void) {
     str_t *str_tmp = iec_get_string(rst_tmp);
     printf("t: %d, l: %d(%s)(%s)\n", rst_tmp->type, stringLength(str_tmp), stringValue(str_tmp), (((string_t*) (rst_tmp->value))->str->value));
     printf("-pp p:%p/%p\n", (((string_t*) (rst_tmp->value))->str->value), strt);
+
+    iec_t str_move = IEC_ALLOC;
+    iec_init(&str_move, IEC_T_INT);
+    res = iec_move(&str_move, rst_tmp);
+    assert(res == IEC_OK);
+    assert(str_move->type == IEC_T_STRING);
+    assert(strcmp(stringValue(iec_get_string(str_move)), strt) == 0);
+    char *str_buffer = stringValue(iec_get_string(str_move));
+    iec_string_set(&rst_tmp, "short", 0, 0);
+    res = iec_move(&str_move, rst_tmp);
+    assert(res == IEC_OK);
+    assert(strcmp(stringValue(iec_get_string(str_move)), "short") == 0);
+    assert(stringValue(iec_get_string(str_move)) == str_buffer);
+
+    /* inline storage up to IEC_STRING_SSO, STRING[n] bounded */
+    string_t *str_s = (string_t*) rst_tmp->value;
+    uint32_t str_allocs = iec_heap_allocations();
+    assert(iec_string_set(&rst_tmp, "0123456789012345678901", 0, 0) == IEC_OK);
+    assert(str_s->buffer.value == str_s->local && iec_heap_allocations() == str_allocs);
+    assert(iec_string_set(&rst_tmp, "01234567890123456789012", 0, 0) == IEC_OK);
+    assert(str_s->buffer.value != str_s->local && strlen(stringValue(iec_get_string(rst_tmp))) == 23);
+
+    iec_t str_n = IEC_ALLOC;
+    iec_init(&str_n, IEC_T_NULL);
+    assert(iec_string_init(&str_n, 10, false) == IEC_OK && str_n->type == IEC_T_STRING);
+    assert(iec_string_set(&str_n, "Hello World!", 0, 0) == IEC_TRN);
+    assert(strcmp(stringValue(iec_get_string(str_n)), "Hello Worl") == 0);
+    assert(iec_move(&str_n, rst_tmp) == IEC_TRN && stringLength(iec_get_string(str_n)) == 10);
+    assert(iec_string_init(&str_n, 64, false) == IEC_OK);
+    char *str_fixed = stringValue(iec_get_string(str_n));
+
+    iec_string_set(&rst_tmp, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 0, 0);
+    iec_totype(&v2, IEC_T_INT);
+    iec_totype(&v3, IEC_T_INT);
+    str_allocs = iec_heap_allocations();
+    iec_set_value(v2, 3);
+    assert(iec_string_left(&str_n, rst_tmp, v2) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "ABC") == 0);
+    assert(iec_string_right(&str_n, rst_tmp, v2) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "XYZ") == 0);
+    iec_set_value(v3, 5);
+    assert(iec_string_mid(&str_n, rst_tmp, v2, v3) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "EFG") == 0);
+    iec_set_value(v2, 40);
+    assert(iec_string_right(&str_n, rst_tmp, v2) == IEC_OK && stringLength(iec_get_string(str_n)) == 26);
+    assert(iec_string_mid(&str_n, rst_tmp, v2, v3) == IEC_OK && stringLength(iec_get_string(str_n)) == 22);
+    assert(iec_string_len(&result, str_n) == IEC_OK && iec_get_value(result) == 22);
+    assert(stringValue(iec_get_string(str_n)) == str_fixed && iec_heap_allocations() == str_allocs);
+    // LEN of a STRING never written
+    iec_t str_empty = IEC_ALLOC;
+    iec_init(&str_empty, IEC_T_STRING);
+    assert(iec_get_string(str_empty) == NULL);
+    assert(iec_string_len(&result, str_empty) == IEC_OK && result->type == IEC_T_UDINT && iec_get_uint(result) == 0);
+    iec_deinit(&str_empty);
+    iec_set_value(v3, 28);
+    assert(iec_string_mid(&str_n, rst_tmp, v2, v3) == IEC_OOR);
+    iec_set_value(v2, -1);
+    assert(iec_string_left(&str_n, rst_tmp, v2) == IEC_OOR);
+    iec_set_value(v2, 4);
+    assert(iec_string_left(&str_n, str_n, v2) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "EFGH") == 0);
+
+    /* slices: views until the string changes */
+    iec_slice_t sl_a, sl_b;
+    iec_slice_init(&sl_a);
+    iec_slice_init(&sl_b);
+    str_allocs = iec_heap_allocations();
+    iec_set_value(v2, 3);
+    iec_set_value(v3, 5);
+    assert(iec_string_mid_slice(&sl_a, rst_tmp, v2, v3) == IEC_OK);
+    assert(sl_a.length == 3 && memcmp(sl_a.value, "EFG", 3) == 0);
+    assert(sl_a.value == stringValue(iec_get_string(rst_tmp)) + 4);
+    assert(iec_slice_right(&sl_b, &sl_a, 2) == IEC_OK && memcmp(sl_b.value, "FG", 2) == 0);
+    assert(iec_slice_find(&sl_a, "FG", 2) == 2 && iec_slice_find(&sl_a, "GH", 2) == 0);
+    assert(iec_slice_mid(&sl_b, &sl_a, 1, 5) == IEC_OOR);
+    assert(iec_heap_allocations() == str_allocs && sl_a.owned == NULL);
+    iec_string_set(&rst_tmp, "abcdefghijklmnopqrstuvwxyz", 0, 0);
+    assert(sl_a.parent == NULL && sl_a.owned != NULL && memcmp(sl_a.value, "EFG", 3) == 0);
+    assert(sl_b.parent == NULL && memcmp(sl_b.value, "FG", 2) == 0);
+    assert(iec_slice_left(&sl_b, &sl_a, 1) == IEC_OK && sl_b.owned != NULL && sl_b.value[0] == 'E');
+    assert(iec_slice_materialize(&str_n, &sl_a) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "EFG") == 0);
+    assert(iec_string_left_slice(&sl_a, rst_tmp, v2) == IEC_OK && memcmp(sl_a.value, "abc", 3) == 0);
+    assert(iec_string_right_slice(&sl_b, rst_tmp, v2) == IEC_OK && memcmp(sl_b.value, "xyz", 3) == 0);
+    assert(((string_t*) rst_tmp->value)->slices != NULL);
+    iec_slice_release(&sl_a);
+    iec_slice_release(&sl_b);
+    assert(((string_t*) rst_tmp->value)->slices == NULL);
+
+    /* detached only when storage moves or is written; a scoped slice unlinks itself */
+    assert(iec_string_left_slice(&sl_a, rst_tmp, v2) == IEC_OK);
+    assert(iec_string_reserve((string_t*) rst_tmp->value, 10) == IEC_OK && sl_a.parent != NULL && sl_a.owned == NULL);
+    iec_string_set(&rst_tmp, "abcdefghijklmnopqrstuvwxyz", 0, 0);
+    assert(sl_a.parent == NULL && memcmp(sl_a.value, "abc", 3) == 0);
+    iec_slice_release(&sl_a);
+    {
+        iec_slice_t sl_scope IEC_SLICE_SCOPE = IEC_SLICE_EMPTY;
+        assert(iec_slice_string(&sl_scope, rst_tmp) == IEC_OK && ((string_t*) rst_tmp->value)->slices == &sl_scope);
+    }
+    assert(((string_t*) rst_tmp->value)->slices == NULL);
+
+    iec_string_set(&str_n, "xyz", 0, 0);
+    assert(iec_string_find(&result, rst_tmp, str_n) == IEC_OK && result->type == IEC_T_INT && iec_get_value(result) == 24);
+    iec_string_set(&str_n, "xzy", 0, 0);
+    assert(iec_string_find(&result, rst_tmp, str_n) == IEC_OK && iec_get_value(result) == 0);
+    iec_totype(&v3, IEC_T_CHAR);
+    v3->v_char = 'k';
+    assert(iec_string_find(&result, rst_tmp, v3) == IEC_OK && iec_get_value(result) == 11);
+
+    iec_t cc_args[5] = { rst_tmp, v3, str_n, rst_tmp, rst_tmp };
+    iec_string_init(&str_n, 64, false);
+    iec_string_set(&str_n, "-", 0, 0);
+    str_fixed = stringValue(iec_get_string(str_n));
+    iec_t cc_res = IEC_ALLOC;
+    iec_init(&cc_res, IEC_T_NULL);
+    iec_string_init(&cc_res, 64, false);
+    str_allocs = iec_heap_allocations();
+    assert(iec_string_concat_n(&cc_res, cc_args, 3) == IEC_OK && stringLength(iec_get_string(cc_res)) == 28);
+    assert(strcmp(stringValue(iec_get_string(cc_res)), "abcdefghijklmnopqrstuvwxyzk-") == 0);
+    assert(iec_heap_allocations() == str_allocs);
+    assert(iec_string_concat_n(&cc_res, cc_args, 5) == IEC_TRN && stringLength(iec_get_string(cc_res)) == 64);
+    assert(strcmp(stringValue(iec_get_string(cc_res)) + 26, "k-abcdefghijklmnopqrstuvwxyzabcdefghij") == 0);
+    assert(iec_heap_allocations() == str_allocs);
+    cc_args[0] = str_n;
+    cc_args[2] = str_n;
+    assert(iec_string_concat_n(&str_n, cc_args, 3) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "-k-") == 0);
+    cc_args[2] = v3;
+    assert(iec_string_concat_n(&str_n, cc_args, 3) == IEC_OK && strcmp(stringValue(iec_get_string(str_n)), "-k-kk") == 0);
+    assert(stringValue(iec_get_string(str_n)) == str_fixed);
+    assert(iec_string_concat_n(&str_n, cc_args + 1, 2) == IEC_NAT);
+    assert(iec_string_concat_n(&str_n, cc_args, 0) == IEC_ENL);
+
+    stack_t cc_list = stack_create();
+    stack_push(cc_list, rst_tmp);
+    stack_push(cc_list, v3);
+    stack_push(cc_list, rst_tmp);
+    assert(iec_string_concat(&result, cc_list) == IEC_OK && stack_empty(cc_list));
+    assert(result->type == IEC_T_STRING && stringLength(iec_get_string(result)) == 53);
+    assert(stringValue(iec_get_string(result))[26] == 'k');
+    stack_release(cc_list);
+    iec_deinit(&cc_res);
+
+    /* EQ/NE: hash reject, interned by pointer */
+    iec_t eq_a = IEC_ALLOC, eq_b = IEC_ALLOC, eq_c = IEC_ALLOC;
+    iec_init(&eq_a, IEC_T_NULL);
+    iec_init(&eq_b, IEC_T_NULL);
+    iec_init(&eq_c, IEC_T_NULL);
+    iec_string_set(&eq_a, "RUNNING", 0, 1);
+    iec_string_set(&eq_b, "RUNNING", 0, 0);
+    assert(iec_eq(&result, eq_a, eq_b) == IEC_OK && result->type == IEC_T_BOOL && result->v_bool);
+    assert(iec_ne(&result, eq_a, eq_b) == IEC_OK && !result->v_bool);
+    iec_string_set(&eq_b, "RUNNINg", 0, 1);
+    assert(iec_eq(&result, eq_a, eq_b) == IEC_OK && !result->v_bool);
+    iec_string_set(&eq_b, "RUNNING", 0, 0);
+    assert(((string_t*) eq_b->value)->hash == 0 && iec_eq(&result, eq_a, eq_b) == IEC_OK && result->v_bool);
+    // different known hashes reject before characters are compared
+    ((string_t*) eq_b->value)->hash = ((string_t*) eq_a->value)->hash ^ 1;
+    assert(iec_eq(&result, eq_a, eq_b) == IEC_OK && !result->v_bool);
+    iec_string_set(&eq_b, "RUN", 0, 0);
+    assert(iec_ne(&result, eq_a, eq_b) == IEC_OK && result->v_bool);
+
+    iec_intern_t intern;
+    assert(iec_intern_init(&intern, 2) == IEC_OK && intern.capacity == 16);
+    iec_string_set(&eq_b, "RUNNING", 0, 0);
+    assert(iec_string_intern(&intern, eq_a) == IEC_OK && iec_string_intern(&intern, eq_b) == IEC_OK);
+    assert(intern.count == 1 && iec_get_string(eq_a) == iec_get_string(eq_b));
+    assert(iec_eq(&result, eq_a, eq_b) == IEC_OK && result->v_bool);
+    assert(iec_move(&eq_c, eq_a) == IEC_OK && iec_get_string(eq_c) == iec_get_string(eq_a));
+    iec_string_set(&eq_c, "FAULT", 0, 0);
+    assert(strcmp(stringValue(iec_get_string(eq_a)), "RUNNING") == 0);
+    assert(iec_ne(&result, eq_a, eq_c) == IEC_OK && result->v_bool);
+    assert(iec_string_intern(&intern, eq_c) == IEC_OK && intern.count == 2);
+    str_t *eq_fault = iec_get_string(eq_c);
+    char eq_chars[24];
+    for (int n = 0; n < 100; n++) {
+        snprintf(eq_chars, sizeof(eq_chars), "STATE %d", n);
+        iec_string_set(&eq_b, eq_chars, 0, 0);
+        assert(iec_string_intern(&intern, eq_b) == IEC_OK);
+    }
+    assert(intern.count == 102 && intern.capacity == 256);
+    iec_string_set(&eq_b, "FAULT", 0, 0);
+    assert(iec_string_intern(&intern, eq_b) == IEC_OK && iec_get_string(eq_b) == eq_fault);
+    // at the growth threshold a lookup of an existing entry doesn't grow
+    for (int n = 100; intern.count < intern.capacity / 2; n++) {
+        snprintf(eq_chars, sizeof(eq_chars), "STATE %d", n);
+        iec_string_set(&eq_b, eq_chars, 0, 0);
+        assert(iec_string_intern(&intern, eq_b) == IEC_OK);
+    }
+    iec_string_set(&eq_b, "FAULT", 0, 0);
+    assert(iec_string_intern(&intern, eq_b) == IEC_OK && intern.capacity == 256 && intern.count == 128);
+    assert(((string_t*) eq_b->value)->interned && iec_get_string(eq_b) == eq_fault);
+    // storage not owned by the string but not interned is copied, not shared
+    str_t eq_extern = { .value = "EXTERN", .length = 6, .capacity = 7 };
+    ((string_t*) eq_b->value)->str = &eq_extern;
+    ((string_t*) eq_b->value)->len = 6;
+    ((string_t*) eq_b->value)->interned = false;
+    assert(iec_move(&eq_c, eq_b) == IEC_OK && iec_get_string(eq_c) != &eq_extern);
+    assert(!((string_t*) eq_c->value)->interned && strcmp(stringValue(iec_get_string(eq_c)), "EXTERN") == 0);
+    ((string_t*) eq_b->value)->str = &((string_t*) eq_b->value)->buffer;
+    assert(iec_string_intern(&intern, v3) == IEC_NAT);
+    iec_deinit(&eq_a);
+    iec_deinit(&eq_b);
+    iec_deinit(&eq_c);
+    iec_intern_release(&intern);
+
+    iec_deinit(&str_n);
+    iec_deinit(&str_move);
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST FASTPATH... ");
+
+    iec_t f1 = IEC_ALLOC;
+    iec_t f2 = IEC_ALLOC;
+    iec_init(&f1, IEC_T_INT);
+    iec_init(&f2, IEC_T_INT);
+    f1->v_int16 = 32767;
+    f2->v_int16 = 2;
+
+    res = iec_add_INT_INT(&result, f1, f2);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_INT);
+    assert(result->v_int16 == -32767);
+
+    res = iec_mul_INT_INT(&result, f1, f2);
+    assert(res == IEC_OK);
+    assert(result->v_int16 == -2);
+
+    res = iec_gt_INT_INT(&result, f1, f2);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_BOOL && result->v_bool);
+
+    f2->v_int16 = 0;
+    res = iec_div_INT_INT(&result, f1, f2);
+    assert(res == IEC_NAT);
+
+    iec_totype(&f1, IEC_T_REAL);
+    iec_totype(&f2, IEC_T_REAL);
+    f1->v_float = 5;
+    f2->v_float = 2;
+    res = iec_div_REAL_REAL(&result, f1, f2);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_REAL && result->v_float == 2.5f);
+    res = iec_le_REAL_REAL(&result, f1, f2);
+    assert(res == IEC_OK);
+    assert(!result->v_bool);
+
+    res = iec_fast_div(&result, INT32_MIN, -1);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_DINT && result->v_int32 == INT32_MIN);
+
+    res = iec_fast_shl(&result, (uint16_t) 0x8001, 1);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_UINT && result->v_uint16 == 2);
+
+    res = iec_fast_shr(&result, (int8_t) -128, 9);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_SINT && result->v_int8 == 0);
+
+    res = iec_fast_mod(&result, (uint8_t) 7, 0);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_USINT && result->v_uint8 == 0);
+
+    res = iec_fast_eq(&result, 0.5, 0.5);
+    assert(res == IEC_OK);
+    assert(result->type == IEC_T_BOOL && result->v_bool);
+
+    iec_deinit(&f1);
+    iec_deinit(&f2);
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST IMAGE... ");
+
+    iec_image_t image;
+    iec_image_init(&image);
+    iec_handle_t h[100];
+    for (int n = 0; n < 100; n++) {
+        res = iec_image_add(&image, IEC_T_DINT, &h[n]);
+        assert(res == IEC_OK);
+    }
+    iec_handle_t hr;
+    res = iec_image_add(&image, IEC_T_LREAL, &hr);
+    assert(res == IEC_OK);
+    assert(iec_image_add(&image, IEC_T_STRING, &hr) == IEC_NAT);
+    assert(IEC_HANDLE_TYPE(h[99]) == IEC_T_DINT && IEC_HANDLE_INDEX(h[99]) == 99);
+
+    int32_t inputs[100];
+    for (int n = 0; n < 100; n++)
+        inputs[n] = n * 10;
+    iec_image_snapshot(&image);
+    res = iec_image_copy_in(&image, IEC_T_DINT, 0, inputs, 100);
+    assert(res == IEC_OK);
+    assert(*((int32_t*) iec_image_ptr(&image, h[42])) == 420);
+
+    iec_handle_t changed[128];
+    assert(iec_image_cov(&image, IEC_T_DINT, changed, 128) == 99);
+    assert(changed[0] == h[1]);
+    assert(iec_image_cov(&image, IEC_T_DINT, changed, 128) == 0);
+
+    res = iec_image_call2(&image, iec_sub, h[0], h[5], h[2]);
+    assert(res == IEC_OK);
+    assert(*((int32_t*) iec_image_ptr(&image, h[0])) == 30);
+    res = iec_image_call2(&image, iec_div, hr, h[5], h[2]);
+    assert(res == IEC_OK);
+    assert(*((double*) iec_image_ptr(&image, hr)) == 2);
+    assert(iec_image_cov(&image, IEC_T_DINT, changed, 128) == 1 && changed[0] == h[0]);
+
+    struct iec_t view;
+    res = iec_image_view(&image, h[3], &view);
+    assert(res == IEC_OK);
+    assert(iec_get_int(&view) == 30);
+    int32_t outputs[4];
+    res = iec_image_copy_out(&image, IEC_T_DINT, 0, outputs, 4);
+    assert(res == IEC_OK);
+    assert(outputs[0] == 30 && outputs[3] == 30);
+    assert(iec_image_copy_out(&image, IEC_T_DINT, 98, outputs, 4) == IEC_ENL);
+    iec_image_release(&image);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST BATCH... ");
+
+    static int32_t ba[67], bb[67], bs[67], bv[67];
+    static double da[67], db[67], ds[67], dv[67];
+    for (int n = 0; n < 67; n++) {
+        ba[n] = n * 1000 - 30000;
+        bb[n] = (n % 5) - 2;
+        da[n] = n * 0.5;
+        db[n] = n + 1;
+    }
+
+    uint8_t (*const batch_fn[])(void*, const void*, const void*, size_t, iectype_t) = {
+        iec_add_batch, iec_sub_batch, iec_mul_batch, iec_div_batch
+    };
+    for (int f = 0; f < 4; f++) {
+        iec_batch_max_level = IEC_BATCH_NONE;
+        uint8_t rs = batch_fn[f](bs, ba, bb, 67, IEC_T_DINT);
+        uint8_t rd = batch_fn[f](ds, da, db, 67, IEC_T_LREAL);
+        for (int level = IEC_BATCH_SSE2; level <= IEC_BATCH_AVX2; level++) {
+            iec_batch_max_level = level;
+            assert(batch_fn[f](bv, ba, bb, 67, IEC_T_DINT) == rs);
+            assert(memcmp(bs, bv, sizeof(bs)) == 0);
+            assert(batch_fn[f](dv, da, db, 67, IEC_T_LREAL) == rd);
+            assert(memcmp(ds, dv, sizeof(ds)) == 0);
+        }
+    }
+    iec_batch_max_level = IEC_BATCH_AVX2;
+
+    res = iec_div_batch(bv, ba, bb, 67, IEC_T_DINT);
+    assert(res == IEC_OOR);
+    assert(bv[2] == 0 && bv[0] == 15000);
+    bb[0] = INT32_MAX;
+    res = iec_add_batch(bv, bb, bb, 1, IEC_T_DINT);
+    assert(res == IEC_TRN);
+    assert(iec_add_batch(bv, ba, ba, 67, IEC_T_DINT) == IEC_OK);
+
+    int16_t ia[19], ib[19], iv[19];
+    for (int n = 0; n < 19; n++) {
+        ia[n] = 200;
+        ib[n] = n;
+    }
+    assert(iec_mul_batch(iv, ia, ib, 19, IEC_T_INT) == IEC_OK && iv[18] == 3600);
+    ia[17] = 2000;
+    assert(iec_mul_batch(iv, ia, ib, 19, IEC_T_INT) == IEC_TRN && iv[17] == (int16_t) 34000);
+    ib[0] = -1;
+    assert(iec_expt_batch(iv, ia, ib, 1, IEC_T_INT) == IEC_TRN && iv[0] == 0);
+    ib[0] = 3;
+    assert(iec_expt_batch(iv, ia, ib, 1, IEC_T_INT) == IEC_TRN && iv[0] == INT16_MAX);
+    assert(iec_mod_batch(dv, da, db, 67, IEC_T_LREAL) == IEC_NAT);
+
+    static int64_t la[67], lb[67];
+    static float fa[67], fb[67];
+    for (int n = 0; n < 67; n++) {
+        la[n] = ia[n % 19] = fa[n] = n % 7;
+        lb[n] = ib[n % 19] = fb[n] = 3;
+    }
+    fa[66] = NAN;
+    uint8_t (*const cmp_fn[])(uint64_t*, const void*, const void*, size_t, iectype_t) = {
+        iec_gt_batch, iec_ge_batch, iec_eq_batch, iec_le_batch, iec_lt_batch, iec_ne_batch
+    };
+    const iectype_t cmp_type[] = { IEC_T_INT, IEC_T_DINT, IEC_T_LINT, IEC_T_REAL, IEC_T_LREAL };
+    const void *cmp_a[] = { ia, ba, la, fa, da };
+    const void *cmp_b[] = { ib, bb, lb, fb, db };
+    const size_t cmp_n[] = { 19, 67, 67, 67, 67 };
+    uint64_t ms[2], mv[2];
+    for (int f = 0; f < 6; f++) {
+        for (int t = 0; t < 5; t++) {
+            iec_batch_max_level = IEC_BATCH_NONE;
+            assert(cmp_fn[f](ms, cmp_a[t], cmp_b[t], cmp_n[t], cmp_type[t]) == IEC_OK);
+            for (int level = IEC_BATCH_SSE2; level <= IEC_BATCH_AVX2; level++) {
+                iec_batch_max_level = level;
+                assert(cmp_fn[f](mv, cmp_a[t], cmp_b[t], cmp_n[t], cmp_type[t]) == IEC_OK);
+                assert(memcmp(ms, mv, IEC_BATCH_MASK_WORDS(cmp_n[t]) * sizeof(uint64_t)) == 0);
+            }
+        }
+    }
+    iec_batch_max_level = IEC_BATCH_AVX2;
+
+    iec_gt_batch(ms, la, lb, 67, IEC_T_LINT);
+    assert(ms[0] == 0x70E1C3870E1C3870ULL && ms[1] == 0);
+    iec_ne_batch(ms, fa, fb, 67, IEC_T_REAL);
+    assert((ms[1] >> 2) == 1);
+    iec_eq_batch(ms, fa, fb, 67, IEC_T_REAL);
+    assert((ms[1] >> 2) == 0);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST BITWISE... ");
+
+    iec_totype(&v1, IEC_T_BOOL);
+    iec_set_value(v1, true);
+    iec_totype(&v2, IEC_T_BOOL);
+    iec_set_value(v2, false);
+    assert(iec_and(&result, v1, v2) == IEC_OK && result->type == IEC_T_BOOL && result->v_bool == false);
+    assert(iec_or(&result, v1, v2) == IEC_OK && result->v_bool == true);
+    assert(iec_xor(&result, v1, v1) == IEC_OK && result->v_bool == false);
+    assert(iec_not(&result, v2) == IEC_OK && result->type == IEC_T_BOOL && result->v_bool == true);
+    iec_totype(&v1, IEC_T_WORD);
+    iec_set_value(v1, 0xF0F0);
+    iec_totype(&v2, IEC_T_USINT);
+    iec_set_value(v2, 0x3C);
+    assert(iec_and(&result, v1, v2) == IEC_OK && result->type == IEC_T_WORD && result->v_uint16 == 0x0030);
+    assert(iec_or(&result, v1, v2) == IEC_OK && result->v_uint16 == 0xF0FC);
+    assert(iec_xor(&result, v1, v2) == IEC_OK && result->v_uint16 == 0xF0CC);
+    assert(iec_not(&result, v1) == IEC_OK && result->type == IEC_T_WORD && result->v_uint16 == 0x0F0F);
+    iec_totype(&v1, IEC_T_REAL);
+    iec_set_value(v1, 1.0);
+    assert(iec_and(&result, v1, v2) == IEC_NAT);
+
+    iec_bool_bank_t bk_a, bk_b, bk_s, bk_v;
+    assert(iec_bool_bank_init(&bk_a, 300) == IEC_OK);
+    iec_bool_bank_init(&bk_b, 300);
+    iec_bool_bank_init(&bk_s, 300);
+    iec_bool_bank_init(&bk_v, 300);
+    for (uint32_t n = 0; n < 300; n++) {
+        iec_bool_bank_set(&bk_a, n, n % 3 == 0);
+        iec_bool_bank_set(&bk_b, n, n % 2 == 0);
+    }
+    uint8_t (*const bank_fn[])(iec_bool_bank_t*, const iec_bool_bank_t*, const iec_bool_bank_t*) = {
+        iec_and_bank, iec_or_bank, iec_xor_bank
+    };
+    for (int f = 0; f < 3; f++) {
+        iec_batch_max_level = IEC_BATCH_NONE;
+        assert(bank_fn[f](&bk_s, &bk_a, &bk_b) == IEC_OK);
+        for (uint32_t n = 0; n < 300; n++) {
+            bool x = n % 3 == 0, y = n % 2 == 0;
+            assert(iec_bool_bank_get(&bk_s, n) == (f == 0 ? (x && y) : f == 1 ? (x || y) : (x != y)));
+        }
+        for (int level = IEC_BATCH_SSE2; level <= IEC_BATCH_AVX2; level++) {
+            iec_batch_max_level = level;
+            bank_fn[f](&bk_v, &bk_a, &bk_b);
+            assert(memcmp(bk_s.words, bk_v.words, IEC_BATCH_MASK_WORDS(300) * sizeof(uint64_t)) == 0);
+        }
+    }
+    for (int level = IEC_BATCH_NONE; level <= IEC_BATCH_AVX2; level++) {
+        iec_batch_max_level = level;
+        assert(iec_not_bank(&bk_v, &bk_a) == IEC_OK);
+        for (uint32_t n = 0; n < 300; n++)
+            assert(iec_bool_bank_get(&bk_v, n) == (n % 3 != 0));
+        assert((bk_v.words[4] >> 44) == 0);
+    }
+
+    assert(iec_bool_bank_load(&bk_v, 1, &v1) == IEC_OK && v1->type == IEC_T_BOOL && v1->v_bool == true);
+    assert(iec_bool_bank_load(&bk_v, 300, &v1) == IEC_ENL);
+    iec_totype(&v1, IEC_T_BOOL);
+    iec_set_value(v1, false);
+    assert(iec_bool_bank_store(&bk_v, 1, v1) == IEC_OK && !iec_bool_bank_get(&bk_v, 1));
+    assert(iec_bool_bank_store(&bk_v, 1, v2) == IEC_NAT);
+
+    iec_gt_batch(bk_s.words, ba, bb, 67, IEC_T_DINT);
+    bk_s.count = 67;
+    bk_a.count = bk_v.count = 67;
+    iec_not_bank(&bk_v, &bk_s);
+    iec_lt_batch(bk_a.words, ba, bb, 67, IEC_T_DINT);
+    for (uint32_t n = 0; n < 67; n++)
+        assert(iec_bool_bank_get(&bk_v, n) == (ba[n] <= bb[n]));
+
+    iec_bool_bank_release(&bk_a);
+    iec_bool_bank_release(&bk_b);
+    iec_bool_bank_release(&bk_s);
+    iec_bool_bank_release(&bk_v);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST EDGE... ");
+
+    iec_edge_t ed_r, ed_f;
+    iec_bool_bank_t ed_clk, ed_q, ed_qf;
+    assert(iec_edge_init(&ed_r, 130, false) == IEC_OK);
+    assert(iec_edge_init(&ed_f, 130, true) == IEC_OK);
+    iec_bool_bank_init(&ed_clk, 130);
+    iec_bool_bank_init(&ed_q, 130);
+    iec_bool_bank_init(&ed_qf, 130);
+    iec_t ed_rq = IEC_ALLOC, ed_fq = IEC_ALLOC;
+    iec_init(&ed_rq, IEC_T_BOOL);
+    iec_init(&ed_fq, IEC_T_BOOL);
+    iec_totype(&v1, IEC_T_BOOL);
+    for (int scan = 0; scan < 6; scan++) {
+        for (uint32_t n = 0; n < 130; n++)
+            iec_bool_bank_set(&ed_clk, n, ((n + scan) / 2) % 2);
+        assert(iec_r_trig_batch(&ed_q, &ed_r, &ed_clk) == IEC_OK);
+        assert(iec_f_trig_batch(&ed_qf, &ed_f, &ed_clk) == IEC_OK);
+        iec_set_value(v1, iec_bool_bank_get(&ed_clk, 129));
+        iec_r_trig(&ed_rq, v1);
+        iec_f_trig(&ed_fq, v1);
+        assert(iec_bool_bank_get(&ed_q, 129) == ed_rq->v_bool);
+        assert(iec_bool_bank_get(&ed_qf, 129) == ed_fq->v_bool);
+
+        iec_bits_iter_t it;
+        uint32_t index, visited = 0;
+        iec_bits_iter_init(&it, ed_q.words, 130);
+        while (iec_bits_next(&it, &index)) {
+            assert(index < 130 && iec_bool_bank_get(&ed_q, index) && iec_bool_bank_get(&ed_clk, index));
+            visited++;
+        }
+        for (uint32_t n = 0; n < 130; n++)
+            visited -= iec_bool_bank_get(&ed_q, n);
+        assert(visited == 0);
+    }
+
+    uint64_t ed_clk2[3] = { 0, UINT64_MAX, UINT64_MAX }, ed_rise[3], ed_fall[3];
+    assert(iec_edge_update(&ed_r, ed_clk2, ed_rise, ed_fall) == 65);
+    assert(ed_rise[2] == 1 && ed_fall[0] == 0x6666666666666666ULL && ed_fall[2] == 0);
+    assert(iec_edge_update(&ed_r, ed_clk2, ed_rise, NULL) == 0 && ed_rise[1] == 0);
+
+    iec_free(ed_rq);
+    iec_free(ed_fq);
+    iec_edge_release(&ed_r);
+    iec_edge_release(&ed_f);
+    iec_bool_bank_release(&ed_clk);
+    iec_bool_bank_release(&ed_q);
+    iec_bool_bank_release(&ed_qf);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST TIMER_WHEEL... ");
+
+    iec_wheel_t wheel;
+    uint32_t tw_ton, tw_tof, tw_tp;
+    assert(iec_wheel_init(&wheel, 259, 1000) == IEC_OK);
+    assert(iec_wheel_add(&wheel, IEC_WHEEL_TON, 100, &tw_ton) == IEC_OK);
+    iec_wheel_add(&wheel, IEC_WHEEL_TOF, 100, &tw_tof);
+    iec_wheel_add(&wheel, IEC_WHEEL_TP, 100, &tw_tp);
+    iec_wheel_in(&wheel, tw_ton, true);
+    iec_wheel_in(&wheel, tw_tof, true);
+    iec_wheel_in(&wheel, tw_tp, true);
+    assert(!iec_wheel_q(&wheel, tw_ton) && iec_wheel_q(&wheel, tw_tof) && iec_wheel_q(&wheel, tw_tp));
+    iec_wheel_advance(&wheel, 1099);
+    assert(!iec_wheel_q(&wheel, tw_ton) && iec_wheel_et(&wheel, tw_ton) == 99 && iec_wheel_q(&wheel, tw_tp));
+    iec_wheel_in(&wheel, tw_tof, false);
+    assert(iec_wheel_advance(&wheel, 1100) == 2);
+    assert(iec_wheel_q(&wheel, tw_ton) && iec_wheel_et(&wheel, tw_ton) == 100);
+    assert(!iec_wheel_q(&wheel, tw_tp) && iec_wheel_et(&wheel, tw_tp) == 100);
+    assert(iec_wheel_q(&wheel, tw_tof) && iec_wheel_et(&wheel, tw_tof) == 1);
+    iec_wheel_advance(&wheel, 1198);
+    assert(iec_wheel_q(&wheel, tw_tof));
+    iec_wheel_advance(&wheel, 5000);
+    assert(!iec_wheel_q(&wheel, tw_tof) && iec_wheel_et(&wheel, tw_tof) == 100);
+    iec_wheel_in(&wheel, tw_tp, false);
+    iec_wheel_in(&wheel, tw_ton, false);
+    assert(iec_wheel_et(&wheel, tw_tp) == 0 && !iec_wheel_q(&wheel, tw_ton) && iec_wheel_et(&wheel, tw_ton) == 0);
+    iec_totype(&v1, IEC_T_BOOL);
+    iec_totype(&v2, IEC_T_TIME);
+    assert(iec_wheel_get(&wheel, tw_tof, &v1, &v2) == IEC_OK && v1->v_bool == false && iec_get_value(v2) == 100);
+    assert(iec_wheel_get(&wheel, 3, &v1, &v2) == IEC_ENL);
+
+    /* compare with direct evaluation of every timer on random scans */
+    static iec_wheel_timer_t tw_ref[256];
+    uint32_t tw_id, tw_seed = 12345;
+    uint64_t tw_now = 5000;
+    for (uint32_t n = 0; n < 256; n++) {
+        tw_seed = tw_seed * 1103515245 + 12345;
+        time_t pt = (tw_seed >> 8) % (n % 4 == 0 ? 8 : n % 4 == 1 ? 300 : n % 4 == 2 ? 200000 : 40000000);
+        memset(&tw_ref[n], 0, sizeof(tw_ref[n]));
+        tw_ref[n].kind = n % 3;
+        tw_ref[n].pt = pt;
+        assert(iec_wheel_add(&wheel, n % 3, pt, &tw_id) == IEC_OK && tw_id == n + 3);
+    }
+    for (int scan = 0; scan < 3000; scan++) {
+        tw_seed = tw_seed * 1103515245 + 12345;
+        uint32_t r = tw_seed >> 8;
+        tw_now += r % 100 == 0 ? r % 30000000 : r % 10 == 0 ? r % 5000 : r % 20;
+        iec_wheel_advance(&wheel, tw_now);
+        for (uint32_t n = 0; n < 256; n++) {
+            iec_wheel_timer_t *t = &tw_ref[n];
+            if (t->run && t->t0 + t->pt <= tw_now) {
+                t->run = false;
+                t->done = t->kind != IEC_WHEEL_TP || t->in;
+                t->q = t->kind == IEC_WHEEL_TON;
+            }
+            tw_seed = tw_seed * 1103515245 + 12345;
+            if ((tw_seed >> 8) % 16 == 0) {
+                bool in = !t->in;
+                iec_wheel_in(&wheel, n + 3, in);
+                t->in = in;
+                if (t->kind == IEC_WHEEL_TP) {
+                    if (!in && !t->run)
+                        t->done = false;
+                    if (in && !t->run && t->pt > 0)
+                        t->run = t->q = true, t->t0 = tw_now, t->done = false;
+                } else {
+                    bool start = t->kind == IEC_WHEEL_TON ? in : !in;
+                    t->run = start && t->pt > 0;
+                    t->t0 = tw_now;
+                    t->done = start && t->pt == 0;
+                    t->q = t->kind == IEC_WHEEL_TON ? t->done : (in || t->run);
+                }
+            }
+            time_t et = t->run ? (time_t) (tw_now - t->t0) : t->done ? t->pt : 0;
+            assert(iec_wheel_q(&wheel, n + 3) == t->q);
+            assert(iec_wheel_et(&wheel, n + 3) == et);
+        }
+    }
+    assert(iec_wheel_add(&wheel, IEC_WHEEL_TON, 1, &tw_id) == IEC_OOR);
+    iec_wheel_release(&wheel);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST SCAN... ");
+
+    iec_scan_t scan;
+    iec_scan_init(&scan);
+    iec_scan_begin(&scan);
+    assert(scan.cycle == 1 && iec_scan_delta_ms(&scan) == 0 && iec_scan_current == &scan);
+    scan.ms = 1000;
+    scan.us = 1000000;
+    iec_scan_begin(&scan);
+    scan.ms = 1250;
+    scan.us = 1250500;
+    assert(scan.cycle == 2 && iec_scan_delta_ms(&scan) == 250 && iec_scan_delta_us(&scan) == 250500);
+    assert(iec_scan_delta_s(&scan) == 0.2505 && iec_scan_millis() == 1250);
+
+    iec_t sc_timer = IEC_ALLOC, sc_et = IEC_ALLOC;
+    iec_init(&sc_timer, IEC_T_TIMER);
+    iec_init(&sc_et, IEC_T_TIME);
+    iec_totype(&v1, IEC_T_BOOL);
+    iec_set_value(v1, true);
+    iec_totype(&v2, IEC_T_TIME);
+    iec_set_value(v2, 500);
+    iec_ton(&sc_timer, v1, v2, &sc_et);
+    scan.ms = 1600;
+    iec_ton(&sc_timer, v1, v2, &sc_et);
+    assert(iec_get_value(sc_et) == 350 && !iec_timer(sc_timer)->q);
+    scan.ms = 1750;
+    iec_ton(&sc_timer, v1, v2, &sc_et);
+    assert(iec_get_value(sc_et) == 500 && iec_timer(sc_timer)->q);
+
+    /* TP: a rising edge in the scan that ends a pulse starts the next one */
+    iec_t sc_tp = IEC_ALLOC;
+    iec_init(&sc_tp, IEC_T_TIMER);
+    iec_tp(&sc_tp, v1, v2, &sc_et);
+    assert(iec_timer(sc_tp)->q && iec_get_value(sc_et) == 0);
+    scan.ms = 2000;
+    iec_set_value(v1, false);
+    iec_tp(&sc_tp, v1, v2, &sc_et);
+    assert(iec_timer(sc_tp)->q && iec_get_value(sc_et) == 250);
+    scan.ms = 2250;
+    iec_set_value(v1, true);
+    iec_tp(&sc_tp, v1, v2, &sc_et);
+    assert(iec_timer(sc_tp)->q && iec_get_value(sc_et) == 0);
+    scan.ms = 2800;
+    iec_tp(&sc_tp, v1, v2, &sc_et);
+    assert(!iec_timer(sc_tp)->q && iec_get_value(sc_et) == 500);
+
+    /* TOF: ET counts from the falling edge, not from the clock origin */
+    iec_t sc_tof = IEC_ALLOC;
+    iec_init(&sc_tof, IEC_T_TIMER);
+    iec_tof(&sc_tof, v1, v2, &sc_et);
+    assert(iec_timer(sc_tof)->q && iec_get_value(sc_et) == 0);
+    scan.ms = 3000;
+    iec_set_value(v1, false);
+    iec_tof(&sc_tof, v1, v2, &sc_et);
+    scan.ms = 3499;
+    iec_tof(&sc_tof, v1, v2, &sc_et);
+    assert(iec_timer(sc_tof)->q && iec_get_value(sc_et) == 499);
+    scan.ms = 3500;
+    iec_tof(&sc_tof, v1, v2, &sc_et);
+    assert(!iec_timer(sc_tof)->q && iec_get_value(sc_et) == 500);
+    iec_scan_end(&scan);
+    assert(iec_scan_current == NULL);
+
+    iec_free_value(&sc_timer);
+    iec_free(sc_timer);
+    iec_free_value(&sc_tp);
+    iec_free(sc_tp);
+    iec_free_value(&sc_tof);
+    iec_free(sc_tof);
+    iec_free(sc_et);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST HARDWARE... ");
+
+#ifdef __linux__
+    uint64_t hw_t0 = hw_micros(), hw_m0 = hw_millis();
+    while (hw_micros() - hw_t0 < 3000)
+        ;
+    assert(hw_millis() - hw_m0 >= 2 && hw_millis() - hw_m0 < 1000);
+#endif
+#ifdef HW_HAVE_TSC
+    if (hw_tsc_calibrate(HW_TSC_CALIBRATION_MS)) {
+        uint64_t hw_n0 = hw_tsc_nanos();
+        assert(hw_tsc_nanos() >= hw_n0);
+        int64_t drift = hw_tsc_drift();
+        assert(drift < 1000000 && drift > -1000000);
+
+        /* a 20 ms offset is slewed out over one check period, without stepping back */
+        uint64_t hw_check = hw_tsc.check_ns;
+        hw_tsc.ns0 += 20000000;
+        while (hw_monotonic_nanos() - hw_check < 40000000)
+            ;
+        drift = hw_tsc_drift();
+        assert(drift > 15000000);
+        uint64_t hw_period = hw_tsc.check_ns - hw_check, hw_last = hw_tsc_nanos();
+        hw_check = hw_tsc.check_ns;
+        while (hw_monotonic_nanos() - hw_check < hw_period) {
+            uint64_t hw_n = hw_tsc_nanos();
+            assert(hw_n >= hw_last);
+            hw_last = hw_n;
+        }
+        drift = hw_tsc_drift();
+        assert(drift < 5000000 && drift > -5000000);
+    }
+#endif
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST VIRTUAL_CLOCK... ");
+
+    /* 24 h at 100 ms scans: scalar TP/TON/TOF against the timer wheel */
+    hw_virtual_clock_t vclock;
+    hw_clock_virtual(&vclock, 0);
+    assert(hw_millis() == 0);
+    hw_clock_advance(&vclock, 1500000);
+    assert(hw_millis() == 1 && hw_micros() == 1500);
+
+    const time_t vc_pt[] = { 0, 250, 150000, 3600000 };
+    iec_t vc_timer[12], vc_et[12], vc_pt_v = IEC_ALLOC, vc_in = IEC_ALLOC;
+    iec_wheel_t vc_wheel;
+    iec_scan_t vc_scan;
+    uint32_t vc_seed = 777, vc_id;
+    bool vc_input[12] = { false };
+    uint64_t vc_q = 0;
+    iec_init(&vc_pt_v, IEC_T_TIME);
+    iec_init(&vc_in, IEC_T_BOOL);
+    iec_scan_init(&vc_scan);
+    iec_scan_begin(&vc_scan);
+    iec_wheel_init(&vc_wheel, 12, iec_scan_millis());
+    for (int n = 0; n < 12; n++) {
+        vc_timer[n] = IEC_ALLOC;
+        iec_init(&vc_timer[n], IEC_T_TIMER);
+        vc_et[n] = IEC_ALLOC;
+        iec_init(&vc_et[n], IEC_T_TIME);
+        iec_wheel_add(&vc_wheel, n % 3, vc_pt[n / 3], &vc_id);
+    }
+    for (uint32_t scan = 0; scan < 864000; scan++) {
+        hw_clock_advance(&vclock, 100000000);
+        iec_scan_begin(&vc_scan);
+        iec_wheel_advance(&vc_wheel, iec_scan_millis());
+        for (int n = 0; n < 12; n++) {
+            vc_seed = vc_seed * 1103515245 + 12345;
+            if ((vc_seed >> 8) % 2000 == 0 || (n / 3 == 1 && (vc_seed >> 8) % 5 == 0))
+                vc_input[n] = !vc_input[n];
+            iec_set_value(vc_in, vc_input[n]);
+            iec_set_value(vc_pt_v, vc_pt[n / 3]);
+            switch (n % 3) {
+                case IEC_WHEEL_TP:
+                    iec_tp(&vc_timer[n], vc_in, vc_pt_v, &vc_et[n]);
+                    break;
+                case IEC_WHEEL_TON:
+                    iec_ton(&vc_timer[n], vc_in, vc_pt_v, &vc_et[n]);
+                    break;
+                case IEC_WHEEL_TOF:
+                    iec_tof(&vc_timer[n], vc_in, vc_pt_v, &vc_et[n]);
+                    break;
+            }
+            iec_wheel_in(&vc_wheel, n, vc_input[n]);
+            assert(iec_timer(vc_timer[n])->q == iec_wheel_q(&vc_wheel, n));
+            assert(iec_get_value(vc_et[n]) == iec_wheel_et(&vc_wheel, n));
+            vc_q += iec_timer(vc_timer[n])->q;
+        }
+        iec_scan_end(&vc_scan);
+    }
+    assert(iec_scan_delta_ms(&vc_scan) == 100 && iec_scan_millis() == 86400001);
+    assert(vc_q > 0);
+
+    hw_clock_set(NULL, NULL);
+    for (int n = 0; n < 12; n++) {
+        iec_free_value(&vc_timer[n]);
+        iec_free(vc_timer[n]);
+        iec_free(vc_et[n]);
+    }
+    iec_wheel_release(&vc_wheel);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST TIMER_BANK... ");
+
+    /* 37 timers of each kind: AVX2 and scalar bank against iec_tp/iec_ton/iec_tof */
+    iec_timer_bank_t tb[3], tb_s[3];
+    iec_t tb_timer[3][37], tb_et = IEC_ALLOC;
+    uint32_t tb_seed = 99;
+    uint64_t tb_q = 0;
+    iec_init(&tb_et, IEC_T_TIME);
+    iec_init(&vc_in, IEC_T_BOOL);
+    iec_init(&vc_pt_v, IEC_T_TIME);
+    hw_clock_virtual(&vclock, 0);
+    for (int k = 0; k < 3; k++) {
+        assert(iec_timer_bank_init(&tb[k], k, 37) == IEC_OK);
+        iec_timer_bank_init(&tb_s[k], k, 37);
+        for (uint32_t n = 0; n < 37; n++) {
+            tb[k].pt[n] = tb_s[k].pt[n] = (n % 5) * (n % 3 ? 700 : 30);
+            tb_timer[k][n] = IEC_ALLOC;
+            iec_init(&tb_timer[k][n], IEC_T_TIMER);
+        }
+    }
+    iec_timer_bank_t tb_bad;
+    assert(iec_timer_bank_init(&tb_bad, 3, 1) == IEC_NAT);
+    for (uint32_t scan = 0; scan < 20000; scan++) {
+        hw_clock_advance(&vclock, 10000000 * (scan % 13));
+        uint64_t now = hw_millis();
+        for (int k = 0; k < 3; k++) {
+            for (uint32_t n = 0; n < 37; n++) {
+                tb_seed = tb_seed * 1103515245 + 12345;
+                if ((tb_seed >> 8) % 50 == 0)
+                    iec_timer_bank_in(&tb[k], n, !IEC_TIMER_BANK_GET(tb[k].in, n));
+            }
+            memcpy(tb_s[k].in, tb[k].in, sizeof(uint64_t));
+            iec_timer_bank_update(&tb[k], now);
+            iec_batch_max_level = IEC_BATCH_NONE;
+            iec_timer_bank_update(&tb_s[k], now);
+            iec_batch_max_level = IEC_BATCH_AVX2;
+            assert(memcmp(tb[k].et, tb_s[k].et, 37 * sizeof(uint32_t)) == 0);
+            assert(tb[k].q[0] == tb_s[k].q[0]);
+            for (uint32_t n = 0; n < 37; n++) {
+                iec_set_value(vc_in, IEC_TIMER_BANK_GET(tb[k].in, n));
+                iec_set_value(vc_pt_v, tb[k].pt[n]);
+                if (k == IEC_TIMER_BANK_TP)
+                    iec_tp(&tb_timer[k][n], vc_in, vc_pt_v, &tb_et);
+                else if (k == IEC_TIMER_BANK_TON)
+                    iec_ton(&tb_timer[k][n], vc_in, vc_pt_v, &tb_et);
+                else
+                    iec_tof(&tb_timer[k][n], vc_in, vc_pt_v, &tb_et);
+                assert(iec_timer(tb_timer[k][n])->q == iec_timer_bank_q(&tb[k], n));
+                assert(iec_get_value(tb_et) == tb[k].et[n]);
+                tb_q += iec_timer_bank_q(&tb[k], n);
+            }
+        }
+    }
+    assert(tb_q > 0);
+    hw_clock_set(NULL, NULL);
+
+    for (int k = 0; k < 3; k++) {
+        for (uint32_t n = 0; n < 37; n++) {
+            iec_free_value(&tb_timer[k][n]);
+            iec_free(tb_timer[k][n]);
+        }
+        iec_timer_bank_release(&tb[k]);
+        iec_timer_bank_release(&tb_s[k]);
+    }
+    iec_free(tb_et);
+    iec_free(vc_pt_v);
+    iec_free(vc_in);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST SEARCH... ");
+
+    static char se_hay[3000];
+    char se_needle[80];
+    uint32_t se_seed = 4242;
+    for (int round = 0; round < 3000; round++) {
+        iec_batch_max_level = round % 3; // scalar, SSE2 and AVX2 (if CPU has it)
+        size_t se_len = round % 7 == 0 ? round % 40 : 100 + round % 2900;
+        size_t se_nlen = 1 + round % 80;
+        int se_letters = round % 3 == 0 ? 2 : 4; // small alphabet: many partial matches
+        for (size_t n = 0; n < se_len; n++) {
+            se_seed = se_seed * 1103515245 + 12345;
+            se_hay[n] = 'a' + (se_seed >> 16) % se_letters;
+        }
+        se_seed = se_seed * 1103515245 + 12345;
+        if (se_len >= se_nlen && (se_seed >> 16) % 4 != 0)
+            memcpy(se_needle, se_hay + (se_seed >> 8) % (se_len - se_nlen + 1), se_nlen);
+        else
+            for (size_t n = 0; n < se_nlen; n++) {
+                se_seed = se_seed * 1103515245 + 12345;
+                se_needle[n] = 'a' + (se_seed >> 16) % (se_letters + 1);
+            }
+
+        const char *se_first = NULL, *se_last = NULL;
+        for (size_t n = 0; n + se_nlen <= se_len; n++) {
+            if (memcmp(se_hay + n, se_needle, se_nlen) == 0) {
+                if (se_first == NULL)
+                    se_first = se_hay + n;
+                se_last = se_hay + n;
+            }
+        }
+        assert(search_forward(se_hay, se_len, se_needle, se_nlen) == se_first);
+        assert(search_reverse(se_hay, se_len, se_needle, se_nlen) == se_last);
+    }
+    iec_batch_max_level = IEC_BATCH_AVX2;
+    assert(search_forward(se_hay, 10, "", 0) == se_hay && search_reverse(se_hay, 10, "", 0) == se_hay + 10);
+
+    str_t *se_str = NEW_STRING(64, "key=1;key=22;end");
+    assert(indexOfString(se_str, "key", 0) == 0 && indexOfString(se_str, "key", 1) == 6);
+    assert(indexOfString(se_str, "kez", 0) == NO_RESULT && indexOfString(se_str, "end", 16) == NO_RESULT);
+    assert(lastIndexOfString(se_str, "key") == 6 && lastIndexOfString(se_str, ";end") == 12);
+    assert(lastIndexOfString(se_str, "end;") == NO_RESULT);
+    assert(indexOfChar(se_str, ';', 0) == 5 && indexOfChar(se_str, ';', 6) == 12 && indexOfChar(se_str, 'x', 0) == NO_RESULT);
+
+    memset(se_hay, '-', 2999);
+    se_hay[2999] = '\0';
+    memcpy(se_hay + 2900, "BARCODE:0123456789012345678901234567890123456789", 48);
+    iec_string_set(&rst_tmp, se_hay, 0, 0);
+    iec_string_set(&v3, "0123456789012345678901234567890123456789", 0, 0);
+    assert(iec_string_find(&result, rst_tmp, v3) == IEC_OK && iec_get_value(result) == 2909);
+
+    printf("< OK >\n\n");
+    /////////////////////////////////////
+
+    printf("_  TEST ALLOCATOR... ");
+
+    static uint8_t arena_buffer[1024];
+    arena_t arena;
+    arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    iec_allocator_t arena_allocator = { arena_alloc, arena_free, &arena };
+
+    iec_totype(&v1, IEC_T_INT);
+    iec_totype(&v2, IEC_T_INT);
+    iec_set_value(v1, 7);
+    iec_set_value(v2, 500);
+    stack_push(fstk, (void*) v1);
+    stack_push(fstk, (void*) v2);
+
+    iec_set_allocator(&arena_allocator);
+    iec_t tmp = IEC_ALLOC;
+    assert(arena_owns(&arena, tmp));
+    iec_init(&tmp, IEC_T_TIMER);
+    assert(arena_owns(&arena, tmp->value));
+    iec_deinit(&tmp);
+    iec_t cached = result;
+    res = iec_add(&result, &fstk);
+    assert(res == IEC_OK);
+    assert(result == cached);
+    assert(arena.fallbacks == 0);
+    uint32_t heap_allocs = iec_heap_allocations();
+    void *big = iec_malloc(2 * sizeof(arena_buffer));
+    assert(arena.fallbacks == 1 && iec_heap_allocations() == heap_allocs + 1);
+    iec_free(big);
+    void *late = iec_malloc(32);
+    iec_set_allocator(NULL);
+    // released to the arena that made it, not to the system heap now installed
+    assert(arena_owns(&arena, late));
+    iec_free(late);
+
+    assert(arena.offset > 0);
+    arena_reset(&arena);
+    assert(arena.offset == 0 && arena_buffer[0] == ARENA_POISON);
+
+    static uint8_t pool_buffer[8 * POOL_PAGE_SIZE];
+    pool_t pool;
+    pool_init(&pool, pool_buffer, sizeof(pool_buffer));
+    iec_allocator_t pool_allocator = { pool_alloc, pool_free, &pool };
+
+    iec_set_context_allocator(&pool_allocator);
+    heap_allocs = iec_heap_allocations();
+    iec_t p1 = IEC_ALLOC;
+    iec_init(&p1, IEC_T_TIMER);
+    assert(pool_owns(&pool, p1) && pool_owns(&pool, p1->value));
+    iec_deinit(&p1);
+    assert(pool.in_use == 0);
+    stack_t pstk = stack_create();
+    stack_push(pstk, (void*) v1);
+    stack_push(pstk, (void*) v2);
+    res = iec_mul(&result, &pstk);
+    assert(res == IEC_OK);
+    stack_release(pstk);
+    assert(pool.in_use == 0);
+    iec_set_context_allocator(NULL);
+    iec_deinit(&result);
+    iec_set_context_allocator(&pool_allocator);
+    result = IEC_ALLOC;
+    iec_init(&result, IEC_T_NULL);
+    assert(pool_owns(&pool, result));
+    assert(pool.fallbacks == 0);
+    assert(iec_heap_allocations() == heap_allocs);
+    iec_deinit(&result);
+    assert(pool.in_use == 0);
+    big = iec_malloc((size_t) POOL_MIN_BLOCK << POOL_CLASSES);
+    assert(pool.fallbacks == 1 && iec_heap_allocations() == heap_allocs + 1);
+    iec_free(big);
+    iec_t p2 = IEC_ALLOC;
+    iec_init(&p2, IEC_T_TIMER);
+    iec_set_context_allocator(NULL);
+    // released to the pool after the context allocator is reset
+    assert(pool_owns(&pool, p2) && pool.in_use == 2);
+    iec_deinit(&p2);
+    assert(pool.in_use == 0);
+
+    result = IEC_ALLOC;
+    iec_init(&result, IEC_T_NULL);
+
     printf("< OK >\n\n");
     /////////////////////////////////////
 
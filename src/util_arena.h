@@ -0,0 +1,171 @@
+/**
+ * @file util_arena.h
+ * @brief bump (arena) allocator for per scan temporaries
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef UTIL_ARENA_H_
+#define UTIL_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Memory is taken from a caller supplied buffer by bumping an offset. Single blocks are never released: the whole arena
+ * is released at once with arena_reset (ex: at scan boundary). If the buffer is exhausted the request falls back to
+ * the system heap and is counted in fallbacks.
+ *
+ * arena_alloc/arena_free have the same signature of iec_allocator_t, so the arena can be installed as library allocator:
+ *
+ *     static uint8_t scan_buffer[16384];
+ *     static arena_t arena;
+ *     static iec_allocator_t arena_allocator = { arena_alloc, arena_free, &arena };
+ *     arena_init(&arena, scan_buffer, sizeof(scan_buffer));
+ *     iec_set_allocator(&arena_allocator);
+ *     ...
+ *     arena_reset(&arena);
+ *
+ * Values taken from the arena are invalid after arena_reset and must not be used or released. Define ARENA_POISON
+ * as a byte value to fill the released memory, so a value used after reset fails visibly.
+ */
+
+/**
+ * @def ARENA_ALIGN
+ * @brief alignment of blocks
+ *
+ */
+#ifndef ARENA_ALIGN
+#define ARENA_ALIGN _Alignof(max_align_t)
+#endif
+
+/**
+ * @def ARENA_HEAP_MALLOC
+ * @brief system heap allocation for fallbacks (iec61131lib.h routes it to the library heap counter)
+ *
+ */
+#ifndef ARENA_HEAP_MALLOC
+#define ARENA_HEAP_MALLOC(size) malloc(size)
+#endif
+
+/**
+ * @typedef arena_t
+ * @brief
+ *
+ */
+typedef struct arena_t {
+     uint8_t *buffer;    /**< memory */
+      size_t capacity;   /**< buffer size */
+      size_t offset;     /**< first free byte */
+      size_t peak;       /**< high water mark */
+    uint32_t fallbacks;  /**< requests served by system heap */
+} arena_t;
+
+/**
+ * @fn arena_t* arena_init(arena_t *arena, void *buffer, size_t capacity)
+ * @brief
+ *
+ * @param arena
+ * @param buffer
+ * @param capacity
+ * @return arena
+ */
+arena_t* arena_init(arena_t *arena, void *buffer, size_t capacity) {
+    if (arena == NULL || buffer == NULL)
+        return NULL;
+    arena->buffer = (uint8_t*) buffer;
+    arena->capacity = capacity;
+    arena->offset = 0;
+    arena->peak = 0;
+    arena->fallbacks = 0;
+    return arena;
+}
+
+/**
+ * @fn bool arena_owns(arena_t *arena, const void *ptr)
+ * @brief true if ptr is inside arena buffer
+ *
+ * @param arena
+ * @param ptr
+ * @return
+ */
+static inline bool arena_owns(arena_t *arena, const void *ptr) {
+    return (const uint8_t*) ptr >= arena->buffer && (const uint8_t*) ptr < arena->buffer + arena->capacity;
+}
+
+/**
+ * @fn void* arena_alloc(void *ctx, size_t size)
+ * @brief
+ *
+ * @param ctx arena
+ * @param size
+ * @return pointer to memory
+ */
+void* arena_alloc(void *ctx, size_t size) {
+    arena_t *arena = (arena_t*) ctx;
+    size_t offset = (arena->offset + (ARENA_ALIGN - 1)) & ~((size_t) ARENA_ALIGN - 1);
+
+    if (offset > arena->capacity || size > arena->capacity - offset) {
+        arena->fallbacks++;
+        return ARENA_HEAP_MALLOC(size);
+    }
+
+    arena->offset = offset + size;
+    if (arena->offset > arena->peak)
+        arena->peak = arena->offset;
+
+    return arena->buffer + offset;
+}
+
+/**
+ * @fn void arena_free(void *ctx, void *ptr)
+ * @brief blocks inside arena are released by arena_reset, others are returned to system heap
+ *
+ * @param ctx arena
+ * @param ptr
+ */
+void arena_free(void *ctx, void *ptr) {
+    if (!arena_owns((arena_t*) ctx, ptr))
+        free(ptr);
+}
+
+/**
+ * @fn void arena_reset(arena_t *arena)
+ * @brief release all blocks
+ *
+ * @param arena
+ */
+static inline void arena_reset(arena_t *arena) {
+#ifdef ARENA_POISON
+    memset(arena->buffer, ARENA_POISON, arena->offset);
+#endif
+    arena->offset = 0;
+}
+
+#endif /* UTIL_ARENA_H_ */
@@ -38,6 +38,8 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#include "util_search.h"
+
 #define ENABLE_FLOAT_FORMATTING
 
 #ifdef ENABLE_FLOAT_FORMATTING
@@ -512,22 +514,8 @@ str_t* substringAfter(str_t *source, str_t *destination, const char *separator)
 int32_t lastIndexOfString(str_t *str, const char *stringToFind) {
     if (str == NULL || stringToFind == NULL)
         return NO_RESULT;
-    uint32_t substringLength = strlen(stringToFind);
-
-    uint32_t i = str->length;
-    while (true) {
-        uint32_t step = (i > substringLength) ? substringLength : 1;
-        if (i == 0) {
-            break;
-        }
-        i -= step;
-
-        char *substringPointer = strstr(str->value + i, stringToFind);
-        if (substringPointer != NULL) {
-            return (substringPointer - str->value);
-        }
-    }
-    return NO_RESULT;
+    const char *strPointer = search_reverse(str->value, str->length, stringToFind, strlen(stringToFind));
+    return strPointer != NULL ? (strPointer - str->value) : NO_RESULT;
 }
 
 str_t* substringAfterLast(str_t *source, str_t *destination, const char *separator) {
@@ -791,12 +779,8 @@ bool isBuffStringEqualsIgnoreCase(str_t *one, str_t *two) {
 int32_t indexOfChar(str_t *str, char charToFind, uint32_t fromIndex) {
     if (str == NULL || fromIndex >= str->length)
         return NO_RESULT;
-    for (int32_t i = (int32_t) fromIndex; i < str->length; i++) {
-        if (str->value[i] == charToFind) {
-            return i;
-        }
-    }
-    return NO_RESULT;
+    const char *charPointer = memchr(str->value + fromIndex, charToFind, str->length - fromIndex);
+    return charPointer != NULL ? (charPointer - str->value) : NO_RESULT;
 }
 
 bool isStringStartsWith(str_t *str, const char *prefix, uint32_t toOffset) {
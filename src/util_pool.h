@@ -0,0 +1,229 @@
+/**
+ * @file util_pool.h
+ * @brief fixed capacity pool allocator (size classes over pages of a static buffer)
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef UTIL_POOL_H_
+#define UTIL_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * The buffer is divided in pages of POOL_PAGE_SIZE bytes. A page is assigned on demand to one size class
+ * (POOL_MIN_BLOCK << n) and carved in blocks of that size; released blocks go to the free list of their class and are
+ * reused. The class of a block is taken from its page so blocks have no header.
+ * Requests bigger than the largest class or that don't fit in the buffer fall back to the system heap and are counted
+ * in fallbacks: after initialization a real time thread can check that it never increments.
+ *
+ * pool_alloc/pool_free have the same signature of iec_allocator_t, so the pool can be installed as library allocator:
+ *
+ *     static uint8_t pool_buffer[256 * 1024];
+ *     static pool_t pool;
+ *     static iec_allocator_t pool_allocator = { pool_alloc, pool_free, &pool };
+ *     pool_init(&pool, pool_buffer, sizeof(pool_buffer));
+ *     iec_set_allocator(&pool_allocator);
+ */
+
+/**
+ * @def POOL_PAGE_SIZE
+ * @brief size of page
+ *
+ */
+#ifndef POOL_PAGE_SIZE
+#define POOL_PAGE_SIZE 4096
+#endif
+
+/**
+ * @def POOL_MIN_BLOCK
+ * @brief size of smallest class
+ *
+ */
+#ifndef POOL_MIN_BLOCK
+#define POOL_MIN_BLOCK 16
+#endif
+
+/**
+ * @def POOL_CLASSES
+ * @brief number of size classes (largest block is POOL_MIN_BLOCK << (POOL_CLASSES - 1))
+ *
+ */
+#ifndef POOL_CLASSES
+#define POOL_CLASSES   8
+#endif
+
+/**
+ * @def POOL_HEAP_MALLOC
+ * @brief system heap allocation for fallbacks (iec61131lib.h routes it to the library heap counter)
+ *
+ */
+#ifndef POOL_HEAP_MALLOC
+#define POOL_HEAP_MALLOC(size) malloc(size)
+#endif
+
+/**
+ * @typedef pool_block_t
+ * @brief free block
+ *
+ */
+typedef struct pool_block_t {
+    struct pool_block_t *next; /**< */
+} pool_block_t;
+
+/**
+ * @typedef pool_t
+ * @brief
+ *
+ */
+typedef struct pool_t {
+         uint8_t *pages;                     /**< first page */
+         uint8_t *page_class;                /**< size class of every page */
+          size_t page_count;                 /**< number of pages */
+          size_t page_next;                  /**< first unassigned page */
+    pool_block_t *free_list[POOL_CLASSES];   /**< released blocks */
+         uint8_t *carve[POOL_CLASSES];       /**< next never used block in page */
+         uint8_t *carve_end[POOL_CLASSES];   /**< end of page in carve */
+        uint32_t in_use;                     /**< blocks allocated */
+        uint32_t fallbacks;                  /**< requests served by system heap */
+} pool_t;
+
+/**
+ * @fn pool_t* pool_init(pool_t *pool, void *buffer, size_t capacity)
+ * @brief
+ *
+ * @param pool
+ * @param buffer
+ * @param capacity
+ * @return pool
+ */
+pool_t* pool_init(pool_t *pool, void *buffer, size_t capacity) {
+    if (pool == NULL || buffer == NULL)
+        return NULL;
+
+    uintptr_t base = (uintptr_t) buffer;
+    uintptr_t end = base + capacity;
+    size_t count = capacity / (POOL_PAGE_SIZE + 1);
+    uintptr_t pages = (base + count + (POOL_MIN_BLOCK - 1)) & ~((uintptr_t) POOL_MIN_BLOCK - 1);
+
+    while (count > 0 && pages + count * POOL_PAGE_SIZE > end)
+        count--;
+
+    pool->page_class = (uint8_t*) buffer;
+    pool->pages = (uint8_t*) pages;
+    pool->page_count = count;
+    pool->page_next = 0;
+    for (uint8_t n = 0; n < POOL_CLASSES; n++) {
+        pool->free_list[n] = NULL;
+        pool->carve[n] = NULL;
+        pool->carve_end[n] = NULL;
+    }
+    pool->in_use = 0;
+    pool->fallbacks = 0;
+
+    return pool;
+}
+
+/**
+ * @fn bool pool_owns(pool_t *pool, const void *ptr)
+ * @brief true if ptr is inside pool pages
+ *
+ * @param pool
+ * @param ptr
+ * @return
+ */
+static inline bool pool_owns(pool_t *pool, const void *ptr) {
+    return (const uint8_t*) ptr >= pool->pages && (const uint8_t*) ptr < pool->pages + pool->page_count * POOL_PAGE_SIZE;
+}
+
+/**
+ * @fn void* pool_alloc(void *ctx, size_t size)
+ * @brief
+ *
+ * @param ctx pool
+ * @param size
+ * @return pointer to memory
+ */
+void* pool_alloc(void *ctx, size_t size) {
+    pool_t *pool = (pool_t*) ctx;
+    uint8_t cls = 0;
+
+    while (cls < POOL_CLASSES && ((size_t) POOL_MIN_BLOCK << cls) < size)
+        cls++;
+    if (cls == POOL_CLASSES)
+        goto fallback;
+
+    if (pool->free_list[cls] != NULL) {
+        pool_block_t *block = pool->free_list[cls];
+        pool->free_list[cls] = block->next;
+        pool->in_use++;
+        return block;
+    }
+
+    if (pool->carve[cls] == pool->carve_end[cls]) {
+        if (pool->page_next == pool->page_count)
+            goto fallback;
+        pool->page_class[pool->page_next] = cls;
+        pool->carve[cls] = pool->pages + pool->page_next * POOL_PAGE_SIZE;
+        pool->carve_end[cls] = pool->carve[cls] + POOL_PAGE_SIZE;
+        pool->page_next++;
+    }
+
+    void *block = pool->carve[cls];
+    pool->carve[cls] += (size_t) POOL_MIN_BLOCK << cls;
+    pool->in_use++;
+    return block;
+
+fallback:
+    pool->fallbacks++;
+    return POOL_HEAP_MALLOC(size);
+}
+
+/**
+ * @fn void pool_free(void *ctx, void *ptr)
+ * @brief blocks inside pool return to its class, others are returned to system heap
+ *
+ * @param ctx pool
+ * @param ptr
+ */
+void pool_free(void *ctx, void *ptr) {
+    pool_t *pool = (pool_t*) ctx;
+
+    if (!pool_owns(pool, ptr)) {
+        free(ptr);
+        return;
+    }
+
+    uint8_t cls = pool->page_class[((uint8_t*) ptr - pool->pages) / POOL_PAGE_SIZE];
+    ((pool_block_t*) ptr)->next = pool->free_list[cls];
+    pool->free_list[cls] = (pool_block_t*) ptr;
+    pool->in_use--;
+}
+
+#endif /* UTIL_POOL_H_ */
@@ -0,0 +1,361 @@
+/**
+ * @file util_search.h
+ * @brief substring search (SSE2 first and last byte filter, Horspool) forward and reverse
+ * @copyright 2022 Emiliano Augusto Gonzalez (hiperiondev). This project is released under MIT license. Contact: egonzalez.hiperion@gmail.com
+ * @see Project Site: https://github.com/hiperiondev/iec61131lib
+ * @note This is based on other projects. Please contact their authors for more information.
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef UTIL_SEARCH_H_
+#define UTIL_SEARCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iec_batch_level.h"
+
+/*
+ * Search of needle in haystack by length (characters may be '\0').
+ *
+ * With SSE2/AVX2 (x86, level of iec_batch_level()) every needle is searched with a first and last byte filter: candidates
+ * are the positions where both the first and the last byte of needle match, 32 (SSE2) or 64 (AVX2) at a time, and
+ * only candidates are compared. Forward search of 1 byte is memchr.
+ *
+ * Without SIMD forward search uses the filter with memchr for the first byte up to SEARCH_LONG_NEEDLE bytes and
+ * Horspool (shift by last byte of window, skip table of 256 bytes) for longer needles; reverse search uses Horspool
+ * from the end (shift by first byte of window).
+ */
+
+/**
+ * @def SEARCH_LONG_NEEDLE
+ * @brief longest needle searched forward with first and last byte filter when SIMD is not available
+ *
+ */
+#ifndef SEARCH_LONG_NEEDLE
+#define SEARCH_LONG_NEEDLE 32
+#endif
+
+#if defined(IEC_BATCH_X86) && !defined(SEARCH_SCALAR)
+#define SEARCH_X86
+#endif
+
+/**
+ * @def SEARCH_SIMD
+ * @brief true if the vector filter is built and iec_batch_level() allows it
+ *
+ */
+#ifdef SEARCH_X86
+#define SEARCH_SIMD() (iec_batch_level() != IEC_BATCH_NONE)
+#else
+#define SEARCH_SIMD() 0
+#endif
+
+/**
+ * @fn static inline int search_compare(const char *a, const char *b, size_t length)
+ * @brief memcmp equality, inline for short lengths (middle of candidates)
+ *
+ * @param a
+ * @param b
+ * @param length
+ * @return 0 if equal
+ */
+static inline int search_compare(const char *a, const char *b, size_t length) {
+    if (length > 8)
+        return memcmp(a, b, length);
+    for (size_t i = 0; i < length; i++)
+        if (a[i] != b[i])
+            return 1;
+    return 0;
+}
+
+#ifdef SEARCH_X86
+/**
+ * @name filter kernels
+ * @brief forward: check windows from *next by pairs of vectors, *next is first window not checked.
+ *        reverse: check windows below *end by pairs of vectors, *end is last window not checked + 1.
+ *        The last pair overlaps the previous one, so only haystacks shorter than a pair are left to scalar code.
+ *        Return occurrence or NULL
+ *
+ */
+/**@{*/
+#define SEARCH_TARGET_sse2  __attribute__((target("sse2")))
+#define SEARCH_TARGET_avx2  __attribute__((target("avx2")))
+
+#define SEARCH_FILTER_MASK(pfx, si, vec, block)                                                   \
+            ((uint64_t) (uint32_t) pfx ## _movemask_epi8(pfx ## _and_ ## si(                      \
+                pfx ## _cmpeq_epi8(first_byte, pfx ## _loadu_ ## si((const vec*) (block))),       \
+                pfx ## _cmpeq_epi8(last_byte, pfx ## _loadu_ ## si((const vec*) ((block) + last))))))
+
+#define SEARCH_FILTER_VEC(isa, pfx, si, vec)                                                      \
+static SEARCH_TARGET_ ## isa uint64_t search_filter_mask_ ## isa(const char *block,               \
+        vec first_byte, vec last_byte, size_t last) {                                             \
+    return SEARCH_FILTER_MASK(pfx, si, vec, block)                                                \
+            | SEARCH_FILTER_MASK(pfx, si, vec, block + sizeof(vec)) << sizeof(vec);               \
+}                                                                                                 \
+                                                                                                  \
+static SEARCH_TARGET_ ## isa const char* search_filter_forward_ ## isa(const char *haystack,      \
+        size_t length, const char *needle, size_t needle_length, size_t *next) {                  \
+    const size_t last = needle_length - 1, windows = length - last, step = 2 * sizeof(vec);       \
+    const vec first_byte = pfx ## _set1_epi8(needle[0]);                                          \
+    const vec last_byte = pfx ## _set1_epi8(needle[last]);                                        \
+    size_t i = *next;                                                                             \
+    while (i + step <= windows || (i < windows && windows >= step)) {                             \
+        uint64_t mask;                                                                            \
+        if (i + step > windows) {                                                                 \
+            /* last pair ends at last window, drop windows already checked */                     \
+            mask = search_filter_mask_ ## isa(haystack + windows - step, first_byte, last_byte,   \
+                    last) >> (i + step - windows);                                                \
+        } else                                                                                    \
+            mask = search_filter_mask_ ## isa(haystack + i, first_byte, last_byte, last);         \
+        while (mask != 0) {                                                                       \
+            uint32_t bit = __builtin_ctzll(mask);                                                 \
+            if (search_compare(haystack + i + bit + 1, needle + 1, last - 1) == 0) {              \
+                *next = i;                                                                        \
+                return haystack + i + bit;                                                        \
+            }                                                                                     \
+            mask &= mask - 1;                                                                     \
+        }                                                                                         \
+        i = i + step <= windows ? i + step : windows;                                             \
+    }                                                                                             \
+    *next = i;                                                                                    \
+    return NULL;                                                                                  \
+}                                                                                                 \
+                                                                                                  \
+static SEARCH_TARGET_ ## isa const char* search_filter_reverse_ ## isa(const char *haystack,      \
+        size_t length, const char *needle, size_t needle_length, size_t *end) {                   \
+    const size_t last = needle_length - 1, windows = length - last, step = 2 * sizeof(vec);       \
+    const size_t middle = needle_length > 2 ? needle_length - 2 : 0;                              \
+    const vec first_byte = pfx ## _set1_epi8(needle[0]);                                          \
+    const vec last_byte = pfx ## _set1_epi8(needle[last]);                                        \
+    size_t e = *end;                                                                              \
+    while (e >= step || (e > 0 && windows >= step)) {                                             \
+        const char *block = haystack + (e >= step ? e - step : 0);                                \
+        uint64_t mask = search_filter_mask_ ## isa(block, first_byte, last_byte, last);           \
+        if (e < step) {                                                                           \
+            /* first pair starts at window 0, drop windows already checked */                     \
+            mask &= ((uint64_t) 1 << e) - 1;                                                      \
+        }                                                                                         \
+        while (mask != 0) {                                                                       \
+            uint32_t bit = 63 - __builtin_clzll(mask);                                            \
+            if (search_compare(block + bit + 1, needle + 1, middle) == 0) {                       \
+                *end = e;                                                                         \
+                return block + bit;                                                               \
+            }                                                                                     \
+            mask &= ~((uint64_t) 1 << bit);                                                       \
+        }                                                                                         \
+        e = e >= step ? e - step : 0;                                                             \
+    }                                                                                             \
+    *end = e;                                                                                     \
+    return NULL;                                                                                  \
+}
+
+SEARCH_FILTER_VEC(sse2, _mm, si128, __m128i)
+SEARCH_FILTER_VEC(avx2, _mm256, si256, __m256i)
+/**@}*/
+#endif
+
+/**
+ * @fn static inline const char* search_filter_forward(const char *haystack, size_t length, const char *needle, size_t needle_length)
+ * @brief first and last byte filter (needle_length >= 2)
+ *
+ * @param haystack
+ * @param length
+ * @param needle
+ * @param needle_length
+ * @return first occurrence or NULL
+ */
+static inline const char* search_filter_forward(const char *haystack, size_t length, const char *needle, size_t needle_length) {
+    const size_t last = needle_length - 1;
+    const char *found = NULL;
+    size_t i = 0;
+
+#ifdef SEARCH_X86
+    switch (iec_batch_level()) {
+        case IEC_BATCH_AVX2:
+            found = search_filter_forward_avx2(haystack, length, needle, needle_length, &i);
+            break;
+        case IEC_BATCH_SSE2:
+            found = search_filter_forward_sse2(haystack, length, needle, needle_length, &i);
+            break;
+        default:
+            break;
+    }
+    if (found != NULL)
+        return found;
+#endif
+
+    while (i + last < length) {
+        found = memchr(haystack + i, needle[0], length - last - i);
+        if (found == NULL)
+            return NULL;
+        i = found - haystack;
+        if (haystack[i + last] == needle[last] && search_compare(haystack + i + 1, needle + 1, last - 1) == 0)
+            return found;
+        i++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static inline const char* search_filter_reverse(const char *haystack, size_t length, const char *needle, size_t needle_length)
+ * @brief first and last byte filter from end
+ *
+ * @param haystack
+ * @param length
+ * @param needle
+ * @param needle_length
+ * @return last occurrence or NULL
+ */
+static inline const char* search_filter_reverse(const char *haystack, size_t length, const char *needle, size_t needle_length) {
+    const size_t last = needle_length - 1;
+    const size_t middle = needle_length > 2 ? needle_length - 2 : 0;
+    size_t end = length - last; // windows [0, end) not checked yet
+
+#ifdef SEARCH_X86
+    const char *found = NULL;
+    switch (iec_batch_level()) {
+        case IEC_BATCH_AVX2:
+            found = search_filter_reverse_avx2(haystack, length, needle, needle_length, &end);
+            break;
+        case IEC_BATCH_SSE2:
+            found = search_filter_reverse_sse2(haystack, length, needle, needle_length, &end);
+            break;
+        default:
+            break;
+    }
+    if (found != NULL)
+        return found;
+#endif
+
+    while (end-- > 0) {
+        if (haystack[end] == needle[0] && haystack[end + last] == needle[last] && search_compare(haystack + end + 1, needle + 1, middle) == 0)
+            return haystack + end;
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static inline const char* search_horspool_forward(const char *haystack, size_t length, const char *needle, size_t needle_length)
+ * @brief Horspool. Shifts are limited to 255
+ *
+ * @param haystack
+ * @param length
+ * @param needle
+ * @param needle_length
+ * @return first occurrence or NULL
+ */
+static inline const char* search_horspool_forward(const char *haystack, size_t length, const char *needle, size_t needle_length) {
+    const size_t last = needle_length - 1;
+    uint8_t shift[256];
+
+    memset(shift, needle_length < 255 ? needle_length : 255, sizeof(shift));
+    for (size_t j = 0; j < last; j++)
+        shift[(uint8_t) needle[j]] = last - j < 255 ? last - j : 255;
+
+    for (size_t i = 0; i + last < length; i += shift[(uint8_t) haystack[i + last]]) {
+        if (haystack[i + last] == needle[last] && memcmp(haystack + i, needle, last) == 0)
+            return haystack + i;
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static inline const char* search_horspool_reverse(const char *haystack, size_t length, const char *needle, size_t needle_length)
+ * @brief Horspool from end (shift by first byte of window). Shifts are limited to 255
+ *
+ * @param haystack
+ * @param length
+ * @param needle
+ * @param needle_length
+ * @return last occurrence or NULL
+ */
+static inline const char* search_horspool_reverse(const char *haystack, size_t length, const char *needle, size_t needle_length) {
+    uint8_t shift[256];
+
+    memset(shift, needle_length < 255 ? needle_length : 255, sizeof(shift));
+    for (size_t j = needle_length - 1; j > 0; j--)
+        shift[(uint8_t) needle[j]] = j < 255 ? j : 255;
+
+    size_t end = length - needle_length + 1; // positions [0, end) not checked yet
+    while (end > 0) {
+        const char *window = haystack + end - 1;
+        if (window[0] == needle[0] && memcmp(window + 1, needle + 1, needle_length - 1) == 0)
+            return window;
+        size_t step = shift[(uint8_t) window[0]];
+        end = end > step ? end - step : 0;
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn const char* search_forward(const char *haystack, size_t length, const char *needle, size_t needle_length)
+ * @brief first occurrence of needle in haystack
+ *
+ * @param haystack
+ * @param length
+ * @param needle
+ * @param needle_length
+ * @return occurrence or NULL (haystack if needle is empty)
+ */
+const char* search_forward(const char *haystack, size_t length, const char *needle, size_t needle_length) {
+    if (needle_length == 0)
+        return haystack;
+    if (needle_length > length)
+        return NULL;
+    if (needle_length == 1)
+        return memchr(haystack, needle[0], length);
+    if (needle_length <= SEARCH_LONG_NEEDLE || SEARCH_SIMD())
+        return search_filter_forward(haystack, length, needle, needle_length);
+
+    return search_horspool_forward(haystack, length, needle, needle_length);
+}
+
+/**
+ * @fn const char* search_reverse(const char *haystack, size_t length, const char *needle, size_t needle_length)
+ * @brief last occurrence of needle in haystack
+ *
+ * @param haystack
+ * @param length
+ * @param needle
+ * @param needle_length
+ * @return occurrence or NULL (end of haystack if needle is empty)
+ */
+const char* search_reverse(const char *haystack, size_t length, const char *needle, size_t needle_length) {
+    if (needle_length == 0)
+        return haystack + length;
+    if (needle_length > length)
+        return NULL;
+    if (SEARCH_SIMD())
+        return search_filter_reverse(haystack, length, needle, needle_length);
+
+    return search_horspool_reverse(haystack, length, needle, needle_length);
+}
+
+#endif /* UTIL_SEARCH_H_ */
@@ -33,27 +33,68 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
- * @typedef stack_node_t
- * @brief
+ * @name allocator
+ * @brief memory allocation used for stack and items
  *
  */
-typedef struct stack_node_t {
-    struct stack_node_t *next; /**< */
-                   void *data; /**< */
-} stack_node_t;
+/**@{*/
+#ifndef STACK_MALLOC
+#define STACK_MALLOC(size) malloc(size)
+#endif
+#ifndef STACK_FREE
+#define STACK_FREE(ptr)    free(ptr)
+#endif
+/**@}*/
+
+/**
+ * @def STACK_RESERVE
+ * @brief initial capacity. 8 pointers fill one 64 bytes cache line
+ *
+ */
+#ifndef STACK_RESERVE
+#define STACK_RESERVE 8
+#endif
 
 /**
  * @typedef stack_t
- * @brief
+ * @brief contiguous array of pointers. Push/pop don't allocate while length is under capacity
  *
  */
 typedef struct stack_t {
-    struct stack_node_t *top;   /**< */
-                    int length; /**< */
+    void **items;    /**< items in push order */
+       int length;   /**< */
+       int capacity; /**< */
 } *stack_t;
 
+/**
+ * @fn bool stack_reserve(stack_t stack, int capacity)
+ * @brief grow storage to hold at least capacity items
+ *
+ * @param stack
+ * @param capacity
+ * @return true if success
+ */
+bool stack_reserve(stack_t stack, int capacity) {
+    if (capacity <= stack->capacity)
+        return true;
+
+    void **items = (void**) STACK_MALLOC(capacity * sizeof(void*));
+    if (items == NULL)
+        return false;
+    if (stack->items != NULL) {
+        memcpy(items, stack->items, stack->length * sizeof(void*));
+        STACK_FREE(stack->items);
+    }
+
+    stack->items = items;
+    stack->capacity = capacity;
+    return true;
+}
+
 /**
  * @fn stack_t stack_create()
  * @brief
@@ -61,11 +102,16 @@ typedef struct stack_t {
  * @return
  */
 stack_t stack_create() {
-    stack_t stack = (struct stack_t*) malloc(sizeof(struct stack_t));
+    stack_t stack = (struct stack_t*) STACK_MALLOC(sizeof(struct stack_t));
     if (stack == NULL)
         return NULL;
     stack->length = 0;
-    stack->top = NULL;
+    stack->capacity = 0;
+    stack->items = NULL;
+    if (!stack_reserve(stack, STACK_RESERVE)) {
+        STACK_FREE(stack);
+        return NULL;
+    }
     return stack;
 }
 
@@ -78,42 +124,21 @@ stack_t stack_create() {
  * @return
  */
 stack_t stack_push(stack_t stack, void *data) {
-    stack_node_t *node = (struct stack_node_t*) malloc(sizeof(struct stack_node_t));
-    if (node == NULL)
+    if (stack->length == stack->capacity && !stack_reserve(stack, stack->capacity * 2))
         return NULL;
-    node->data = data;
-
-    node->next = stack->top;
-    stack->top = node;
 
-    stack->length++;
+    stack->items[stack->length++] = data;
     return stack;
 }
 
 void* stack_pop(stack_t stack) {
-    stack_node_t *current = stack->top;
-    if (current == NULL)
+    if (stack->length == 0)
         return NULL;
-    void *data = current->data;
-    stack->top = stack->top->next;
-
-    free(current);
-    stack->length--;
-    return data;
+    return stack->items[--stack->length];
 }
 
 void stack_flush(stack_t stack) {
-    int length = stack->length;
-    stack_node_t *current, *next;
-    current = stack->top;
-    while (length--) {
-        next = current->next;
-        free(current);
-        current = next;
-    }
-
     stack->length = 0;
-    stack->top = NULL;
 }
 
 int stack_size(stack_t stack) {
@@ -124,9 +149,20 @@ bool stack_empty(stack_t stack) {
     return stack->length == 0 ? 1 : 0;
 }
 
+/**
+ * @fn void** stack_items(stack_t stack)
+ * @brief items in push order (first pushed at index 0), valid until next push
+ *
+ * @param stack
+ * @return items
+ */
+void** stack_items(stack_t stack) {
+    return stack->items;
+}
+
 void stack_release(stack_t stack) {
-    stack_empty(stack);
-    free(stack);
+    STACK_FREE(stack->items);
+    STACK_FREE(stack);
 }
 
 #endif /* UTIL_STACK_H_ */